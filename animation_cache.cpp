@@ -0,0 +1,258 @@
+#include "animation_cache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace {
+
+struct Entry {
+    std::shared_ptr<const Animation> animation;
+    uint64_t stored = 0;   // insertion order, oldest evicted first
+};
+
+std::mutex cache_mutex;
+std::map<std::string, Entry> cache;
+std::set<std::string> too_large;   // paths that didn't fit; streamed from then on
+uint64_t store_count = 0;
+
+size_t totalBytes() {
+    size_t bytes = 0;
+    for (const auto& item : cache) bytes += item.second.animation->bytes();
+    return bytes;
+}
+
+// Smallest size of the frame's aspect ratio that still covers the target
+cv::Mat downscale(const cv::Mat& frame, cv::Size target) {
+    if (target.width <= 0 || target.height <= 0 || frame.empty()) return frame;
+    double scale = std::max(target.width / static_cast<double>(frame.cols),
+                            target.height / static_cast<double>(frame.rows));
+    if (scale >= 1.0) return frame;
+    cv::Mat small;
+    cv::resize(frame, small, cv::Size(static_cast<int>(std::ceil(frame.cols * scale)),
+                                      static_cast<int>(std::ceil(frame.rows * scale))), 0, 0, cv::INTER_AREA);
+    return small;
+}
+
+} // namespace
+
+size_t Animation::bytes() const {
+    size_t total = timestamps.capacity() * sizeof(double) + frames.capacity() * sizeof(cv::Mat);
+    for (const auto& frame : frames) total += frame.total() * frame.elemSize();
+    return total;
+}
+
+// Plays a cached animation, or records the first pass of another source
+// and switches to the cache as soon as some pass of the same path lands there
+class AnimationSource : public FrameSource {
+public:
+    AnimationSource(const std::string& path, std::shared_ptr<const Animation> animation)
+        : path(path), cached(std::move(animation)) {
+        rate = cached->fps;
+        frames = static_cast<int>(cached->frames.size());
+        width = cached->source_width;
+        height = cached->source_height;
+    }
+
+    AnimationSource(const std::string& path, std::unique_ptr<FrameSource> source)
+        : path(path), inner(std::move(source)), recording(std::make_shared<Animation>()) {
+        rate = inner->fps();
+        frames = inner->frameCount();
+        width = inner->frameWidth();
+        height = inner->frameHeight();
+        recording->fps = rate;
+        recording->source_width = width;
+        recording->source_height = height;
+    }
+
+    bool read(cv::Mat& frame) override {
+        if (!cached && next_frame > 0) {
+            // Another pass may have finished meanwhile (the loop source is opened early)
+            std::shared_ptr<const Animation> done = AnimationCache::find(path);
+            if (done && done->frames.size() > next_frame) {
+                cached = std::move(done);
+                inner.reset();
+                recording.reset();
+            }
+        }
+        if (cached) {
+            if (next_frame >= cached->frames.size()) return false;
+            frame = cached->frames[next_frame];
+            last_timestamp = cached->timestamps[next_frame];
+            next_frame++;
+            return true;
+        }
+
+        cv::Mat decoded;
+        if (!inner->read(decoded)) {
+            if (recording && !recording->frames.empty()) publish();
+            recording.reset();
+            return false;
+        }
+        frame = downscale(decoded, target);
+        last_timestamp = inner->timestamp();
+        next_frame++;
+        if (recording) {
+            recording->frames.push_back(frame);
+            recording->timestamps.push_back(last_timestamp);
+            recorded_bytes += frame.total() * frame.elemSize();
+            if (recorded_bytes > AnimationCache::MAX_ANIMATION_BYTES) {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                too_large.insert(path);
+                recording.reset();
+            }
+        }
+        return true;
+    }
+
+    double timestamp() const override { return last_timestamp; }
+    double fps() const override { return rate; }
+    int frameCount() const override { return frames; }
+    int frameWidth() const override { return width; }
+    int frameHeight() const override { return height; }
+
+    bool seek(double ms) override {
+        if (!cached) {
+            std::shared_ptr<const Animation> done = AnimationCache::find(path);
+            if (done && !done->frames.empty()) {
+                cached = std::move(done);
+                inner.reset();
+                recording.reset();
+            }
+        }
+        if (cached) {
+            // The frame on screen at `ms`: the last one starting at or before it
+            const std::vector<double>& times = cached->timestamps;
+            size_t after = std::upper_bound(times.begin(), times.end(), ms) - times.begin();
+            next_frame = after > 0 ? after - 1 : 0;
+            return true;
+        }
+        if (!inner->seek(ms)) return false;
+        // A pass with a hole in it can't be replayed
+        recording.reset();
+        next_frame = static_cast<size_t>(std::max(ms, 0.0) * std::max(rate, 0.0) / 1000.0);
+        return true;
+    }
+
+    void setTargetSize(int target_width, int target_height) override {
+        target = cv::Size(target_width, target_height);
+        if (inner) inner->setTargetSize(target_width, target_height);
+        // Kept too small for a larger view: the next pass decodes again
+        if (cached && !cached->frames.empty()) {
+            const cv::Mat& kept = cached->frames.front();
+            bool reduced = kept.cols < cached->source_width || kept.rows < cached->source_height;
+            if (reduced && (kept.cols < target_width || kept.rows < target_height)) AnimationCache::forget(path);
+        }
+    }
+
+private:
+    void publish() {
+        // Frames decoded before the player asked for a size are larger; match the rest
+        cv::Size size = recording->frames.back().size();
+        for (auto& frame : recording->frames) {
+            if (frame.size() != size) {
+                cv::Mat resized;
+                cv::resize(frame, resized, size, 0, 0, cv::INTER_AREA);
+                frame = resized;
+            }
+        }
+        AnimationCache::store(path, recording);
+    }
+
+    std::string path;
+    std::unique_ptr<FrameSource> inner;
+    std::shared_ptr<Animation> recording;      // null when not recording
+    std::shared_ptr<const Animation> cached;
+    size_t recorded_bytes = 0;
+    size_t next_frame = 0;
+    cv::Size target;
+    double last_timestamp = -1.0;
+    double rate = 0.0;
+    int frames = 0;
+    int width = 0;
+    int height = 0;
+};
+
+std::unique_ptr<FrameSource> AnimationCache::open(const std::string& path) {
+    std::shared_ptr<const Animation> animation = find(path);
+    if (!animation) return nullptr;
+    return std::unique_ptr<FrameSource>(new AnimationSource(path, animation));
+}
+
+std::unique_ptr<FrameSource> AnimationCache::record(const std::string& path, std::unique_ptr<FrameSource> source) {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (too_large.count(path)) return source;
+    }
+    return std::unique_ptr<FrameSource>(new AnimationSource(path, std::move(source)));
+}
+
+std::shared_ptr<const Animation> AnimationCache::find(const std::string& path) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(path);
+    return it != cache.end() ? it->second.animation : nullptr;
+}
+
+void AnimationCache::store(const std::string& path, std::shared_ptr<const Animation> animation) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.erase(path);
+    // Oldest animations make room; anything playing them keeps its frames
+    size_t bytes = animation->bytes();
+    size_t total = totalBytes();
+    while (!cache.empty() && total + bytes > MAX_TOTAL_BYTES) {
+        auto oldest = cache.begin();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->second.stored < oldest->second.stored) oldest = it;
+        }
+        total -= oldest->second.animation->bytes();
+        cache.erase(oldest);
+    }
+    Entry entry;
+    entry.animation = std::move(animation);
+    entry.stored = ++store_count;
+    cache[path] = std::move(entry);
+}
+
+void AnimationCache::forget(const std::string& path) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.erase(path);
+}
+
+size_t AnimationCache::animations() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return cache.size();
+}
+
+size_t AnimationCache::frames() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    size_t count = 0;
+    for (const auto& item : cache) count += item.second.animation->frames.size();
+    return count;
+}
+
+size_t AnimationCache::memoryUsage() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return totalBytes();
+}
+
+size_t AnimationCache::evict(size_t bytes) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    // New references are only made under the lock, so a count of one stays one
+    std::vector<std::map<std::string, Entry>::iterator> idle;
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->second.animation.use_count() == 1) idle.push_back(it);
+    }
+    std::sort(idle.begin(), idle.end(), [](const std::map<std::string, Entry>::iterator& a,
+                                           const std::map<std::string, Entry>::iterator& b) {
+        return a->second.stored < b->second.stored;
+    });
+    size_t freed = 0;
+    for (auto it : idle) {
+        if (freed >= bytes) break;
+        freed += it->second.animation->bytes();
+        cache.erase(it);
+    }
+    return freed;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "frame_source.hpp"
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One decoding pass of a short animation, kept at the size the player
+// resizes to
+struct Animation {
+    std::vector<cv::Mat> frames;
+    std::vector<double> timestamps;
+    double fps = 0.0;
+    int source_width = 0;
+    int source_height = 0;
+
+    size_t bytes() const;
+};
+
+// Short animations (GIFs, short image sequences) are decoded once: the
+// first pass keeps every frame, downscaled to the resize target, and
+// later opens of the same path (loops, repeated playlist entries) play
+// from memory. An animation that outgrows its byte limit is streamed as
+// usual instead. Safe to use from any thread.
+class AnimationCache {
+public:
+    static const size_t MAX_ANIMATION_BYTES = 64u << 20;
+    static const size_t MAX_TOTAL_BYTES = 256u << 20;
+    static const int MAX_SEQUENCE_FRAMES = 300;
+
+    // A source over the decoded frames, or nullptr if the path isn't cached
+    static std::unique_ptr<FrameSource> open(const std::string& path);
+    // Wraps a freshly opened source so its first pass is kept
+    static std::unique_ptr<FrameSource> record(const std::string& path, std::unique_ptr<FrameSource> source);
+
+    static size_t animations();
+    static size_t frames();
+    static size_t memoryUsage();
+    // Drops animations no source is playing, oldest first, until about
+    // `bytes` are freed; returns the bytes freed. Animations in use stay,
+    // since dropping them would free nothing.
+    static size_t evict(size_t bytes);
+
+private:
+    friend class AnimationSource;
+    static std::shared_ptr<const Animation> find(const std::string& path);
+    static void store(const std::string& path, std::shared_ptr<const Animation> animation);
+    static void forget(const std::string& path);
+};
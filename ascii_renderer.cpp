@@ -0,0 +1,349 @@
+#include "ascii_renderer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Longest SGR sequence emitted: "\033[48;2;255;255;255m"
+const size_t MAX_COLOR_CODE = 19;
+const char RESET_CODE[] = "\033[0m";
+const size_t RESET_LENGTH = sizeof(RESET_CODE) - 1;
+const size_t MAX_ROW_MOVE = 16;   // "\033[<row>;1H"
+
+// Pack RGB into uint32_t for caching
+uint32_t packRGB(int r, int g, int b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+}
+
+// Nodes (value, next pointer, cached hash) plus the bucket array
+template <typename Map>
+size_t mapBytes(const Map& map, size_t heap_per_entry) {
+    return map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*) + heap_per_entry) +
+           map.bucket_count() * sizeof(void*);
+}
+
+// Rows a field covers out of a grid of `rows`
+int fieldRows(int rows, int field) {
+    return field < 0 ? rows : std::max(rows - field + 1, 0) / 2;
+}
+
+// Cursor to the start of a field row; rows are counted in the full grid
+char* moveToRow(char* out, int field, int y) {
+    if (field < 0) return out;
+    return out + std::sprintf(out, "\033[%d;1H", field + 2 * y + 1);
+}
+
+char* append(char* out, const std::string& s) {
+    std::memcpy(out, s.data(), s.size());
+    return out + s.size();
+}
+
+} // namespace
+
+const std::string AsciiRenderer::ASCII_CHARS = " .'`^\",:;Il!i><~+_-?][}{1)(|\\/tfjrxnuvczXYUJCLQ0OZmwqpdbkhao*#MW&8%B@$";
+
+AsciiRenderer::AsciiRenderer() {
+    // Initialize brightness lookup table for performance
+    for (int i = 0; i < 256; ++i) {
+        brightness_to_char_idx[i] = (i * (ASCII_CHARS.size() - 1)) / 255;
+    }
+}
+
+cv::Size AsciiRenderer::gridSize(int src_width, int src_height, int target_width, int target_height) {
+    if (target_width <= 0 || target_height <= 0) {
+        target_width = DEFAULT_WIDTH;
+        target_height = DEFAULT_HEIGHT;
+    }
+    if (src_width <= 0 || src_height <= 0) return cv::Size();
+
+    // Calculate proper aspect ratio (characters are taller than wide)
+    float char_aspect_ratio = 2.2f; // Typical character height/width ratio
+    float frame_aspect = static_cast<float>(src_width) / src_height;
+
+    // Compare against the grid's displayed aspect, so neither side can overflow
+    int new_width, new_height;
+    if (frame_aspect > target_width / (target_height * char_aspect_ratio)) {
+        new_width = target_width;
+        new_height = static_cast<int>(target_width / frame_aspect / char_aspect_ratio);
+    } else {
+        new_height = target_height;
+        new_width = static_cast<int>(target_height * frame_aspect * char_aspect_ratio);
+    }
+    return cv::Size(new_width, new_height);
+}
+
+size_t AsciiRenderer::maxOutputSize(const RenderParams& params, int src_width, int src_height) {
+    cv::Size grid = gridSize(src_width, src_height, params.width, params.height);
+    size_t cells = static_cast<size_t>(std::max(grid.width, 0));
+    size_t rows = static_cast<size_t>(fieldRows(std::max(grid.height, 0), params.field));
+    size_t move = params.field < 0 ? 0 : MAX_ROW_MOVE;
+    if (params.color_mode == RenderParams::MONO) {
+        return rows * (move + cells + 1);
+    }
+    return rows * (move + cells * (MAX_COLOR_CODE + 1) + RESET_LENGTH + 1);
+}
+
+size_t AsciiRenderer::render(const PixelBuffer& frame, const RenderParams& params, char* out, size_t capacity) {
+    if (!frame.data || frame.width <= 0 || frame.height <= 0) return 0;
+    size_t stride = frame.stride ? frame.stride : static_cast<size_t>(frame.width) * 3;
+    // Wraps the caller's pixels without copying
+    cv::Mat mat(frame.height, frame.width, CV_8UC3, const_cast<uint8_t*>(frame.data), stride);
+    return renderMat(mat, params, out, capacity);
+}
+
+size_t AsciiRenderer::renderBatch(const PixelBuffer* frames, size_t count, const RenderParams& params,
+                                  char* out, size_t capacity, size_t* lengths) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t written = render(frames[i], params, out + total, capacity - total);
+        if (written == 0 && frames[i].data && frames[i].width > 0 && frames[i].height > 0) return 0;
+        if (lengths) lengths[i] = written;
+        total += written;
+    }
+    return total;
+}
+
+void AsciiRenderer::render(const cv::Mat& frame, const RenderParams& params, std::string& out) {
+    size_t capacity = maxOutputSize(params, frame.cols, frame.rows);
+    out.resize(capacity);
+    out.resize(renderMat(frame, params, &out[0], capacity));
+}
+
+std::string AsciiRenderer::render(const cv::Mat& frame, const RenderParams& params) {
+    std::string out;
+    render(frame, params, out);
+    return out;
+}
+
+size_t AsciiRenderer::renderMat(const cv::Mat& frame, const RenderParams& params, char* out, size_t capacity) {
+    if (frame.empty()) return 0;
+    if (capacity < maxOutputSize(params, frame.cols, frame.rows)) return 0;
+    resizeToGrid(frame, params);
+
+    char* end;
+    if (params.color_mode == RenderParams::MONO) {
+        end = writeMono(resized, params.field, out);
+    } else {
+        end = writeColor(resized, params.block_mode, params.field, out);
+    }
+    return static_cast<size_t>(end - out);
+}
+
+void AsciiRenderer::resizeToGrid(const cv::Mat& frame, const RenderParams& params) {
+    selectColorMode(params.color_mode);
+
+    // Resize frame
+    cv::Size grid = gridSize(frame.cols, frame.rows, params.width, params.height);
+    if (params.field < 0) {
+        cv::resize(frame, resized, grid, 0, 0, cv::INTER_AREA);
+        return;
+    }
+
+    // Only the source bands under this field's rows are read, so an
+    // interlaced frame costs about half
+    int rows = fieldRows(grid.height, params.field);
+    resized.create(rows, grid.width, CV_8UC3);
+    for (int i = 0; i < rows; ++i) {
+        int y = params.field + 2 * i;
+        int y0 = static_cast<int>(static_cast<int64_t>(y) * frame.rows / grid.height);
+        int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(y + 1) * frame.rows / grid.height));
+        cv::resize(frame(cv::Rect(0, y0, frame.cols, y1 - y0)), field_row, cv::Size(grid.width, 1), 0, 0, cv::INTER_AREA);
+        std::memcpy(resized.ptr(i), field_row.ptr(), static_cast<size_t>(grid.width) * 3);
+    }
+}
+
+void AsciiRenderer::renderCells(const cv::Mat& frame, const RenderParams& params, CellGrid& cells) {
+    if (frame.empty()) {
+        cells.resize(0, 0);
+        return;
+    }
+    resizeToGrid(frame, params);
+    cv::Size grid = gridSize(frame.cols, frame.rows, params.width, params.height);
+    if (params.field < 0 || cells.width() != grid.width || cells.height() != grid.height) {
+        cells.resize(grid.width, grid.height);
+    }
+    int field = params.field;
+
+    if (params.color_mode == RenderParams::MONO) {
+        cv::cvtColor(resized, gray, cv::COLOR_BGR2GRAY);
+        cv::equalizeHist(gray, gray);
+        for (int y = 0; y < gray.rows; ++y) {
+            const uint8_t* row = gray.ptr<uint8_t>(y);
+            Cell* out = cells.row(field < 0 ? y : field + 2 * y);
+            for (int x = 0; x < gray.cols; ++x) {
+                out[x] = Cell();
+                out[x].ch = ASCII_CHARS[brightness_to_char_idx[row[x]]];
+            }
+        }
+        return;
+    }
+
+    for (int y = 0; y < resized.rows; ++y) {
+        const cv::Vec3b* row = resized.ptr<cv::Vec3b>(y);
+        Cell* out = cells.row(field < 0 ? y : field + 2 * y);
+        for (int x = 0; x < resized.cols; ++x) {
+            int r = row[x][2], g = row[x][1], b = row[x][0];
+            CellColor color = (params.color_mode == RenderParams::COLOR_8BIT) ?
+                              CellColor::indexed(rgbTo8BitColorCached(r, g, b)) : CellColor::rgb(r, g, b);
+            Cell& cell = out[x];
+            cell = Cell();
+            if (params.block_mode) {
+                cell.bg = color;
+            } else {
+                cell.fg = color;
+                int brightness = static_cast<int>(0.299 * r + 0.587 * g + 0.114 * b);
+                cell.ch = ASCII_CHARS[brightness_to_char_idx[brightness]];
+            }
+        }
+    }
+}
+
+char* AsciiRenderer::writeMono(const cv::Mat& frame, int field, char* out) {
+    // Monochrome mode - convert to grayscale
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    cv::equalizeHist(gray, gray); // Enhance contrast
+
+    for (int y = 0; y < gray.rows; ++y) {
+        const uint8_t* row = gray.ptr<uint8_t>(y);
+        out = moveToRow(out, field, y);
+        for (int x = 0; x < gray.cols; ++x) {
+            *out++ = ASCII_CHARS[brightness_to_char_idx[row[x]]];
+        }
+        *out++ = '\n';
+    }
+    return out;
+}
+
+char* AsciiRenderer::writeColor(const cv::Mat& frame, bool background, int field, char* out) {
+    // Color mode with caching; block style uses background colors and spaces
+    for (int y = 0; y < frame.rows; ++y) {
+        // Every line starts after a reset, so its first cell always needs a color
+        const std::string* last_code = nullptr;
+        cv::Vec3b last_pixel;
+
+        const cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+        out = moveToRow(out, field, y);
+        for (int x = 0; x < frame.cols; ++x) {
+            cv::Vec3b pixel = row[x];
+
+            // Only generate color code if pixel color changed
+            if (!last_code || pixel != last_pixel) {
+                const std::string& code = getColorCodeCached(pixel[2], pixel[1], pixel[0], background); // BGR to RGB
+                if (!last_code || code != *last_code) {
+                    out = append(out, code);
+                    last_code = &code;
+                }
+                last_pixel = pixel;
+            }
+
+            if (background) {
+                *out++ = ' ';
+            } else {
+                // Use pre-computed brightness lookup
+                int brightness = static_cast<int>(0.299 * pixel[2] + 0.587 * pixel[1] + 0.114 * pixel[0]);
+                *out++ = ASCII_CHARS[brightness_to_char_idx[brightness]];
+            }
+        }
+        std::memcpy(out, RESET_CODE, RESET_LENGTH);
+        out += RESET_LENGTH;
+        *out++ = '\n';
+    }
+    return out;
+}
+
+void AsciiRenderer::selectColorMode(RenderParams::ColorMode mode) {
+    if (color_mode == mode) return;
+    color_mode = mode;
+    // Clear caches when switching modes to save memory
+    if (mode != RenderParams::COLOR_8BIT) {
+        color_cache_8bit.clear();
+        rgb_to_8bit_cache.clear();
+    }
+    if (mode != RenderParams::COLOR_24BIT) {
+        color_cache_24bit.clear();
+    }
+    updateCacheSize();
+}
+
+void AsciiRenderer::clearCaches() {
+    // Swap with empty maps so the bucket arrays are released too
+    decltype(color_cache_8bit)().swap(color_cache_8bit);
+    decltype(color_cache_24bit)().swap(color_cache_24bit);
+    decltype(rgb_to_8bit_cache)().swap(rgb_to_8bit_cache);
+    cache_stats = CacheStats(); // Reset stats
+}
+
+size_t AsciiRenderer::memoryUsage() const {
+    // 8-bit codes fit the small string buffer, 24-bit ones need a heap block
+    return mapBytes(color_cache_8bit, 0) + mapBytes(color_cache_24bit, MAX_COLOR_CODE + 1) +
+           mapBytes(rgb_to_8bit_cache, 0) + resized.total() * resized.elemSize() + gray.total() * gray.elemSize();
+}
+
+void AsciiRenderer::updateCacheSize() {
+    cache_stats.cache_size = rgb_to_8bit_cache.size() + color_cache_8bit.size() + color_cache_24bit.size();
+}
+
+// Cached RGB to 8-bit color conversion
+int AsciiRenderer::rgbTo8BitColorCached(int r, int g, int b) {
+    uint32_t rgb_key = packRGB(r, g, b);
+
+    auto it = rgb_to_8bit_cache.find(rgb_key);
+    if (it != rgb_to_8bit_cache.end()) {
+        cache_stats.hits++;
+        return it->second;
+    }
+
+    cache_stats.misses++;
+
+    int color;
+    if (r == g && g == b) {
+        // Grayscale
+        if (r < 8) color = 16;
+        else if (r > 248) color = 231;
+        else color = static_cast<int>(((r - 8) / 247.0) * 24) + 232;
+    } else {
+        // Color cube
+        int ir = static_cast<int>((r / 255.0) * 5);
+        int ig = static_cast<int>((g / 255.0) * 5);
+        int ib = static_cast<int>((b / 255.0) * 5);
+        color = 16 + (36 * ir) + (6 * ig) + ib;
+    }
+
+    if (cache_limit == 0 || rgb_to_8bit_cache.size() < cache_limit) {
+        rgb_to_8bit_cache[rgb_key] = color;
+        updateCacheSize();
+    }
+    return color;
+}
+
+// Cached color code generation
+const std::string& AsciiRenderer::getColorCodeCached(int r, int g, int b, bool background) {
+    ColorKey key = {(uint8_t)r, (uint8_t)g, (uint8_t)b, background};
+    auto& cache = (color_mode == RenderParams::COLOR_8BIT) ? color_cache_8bit : color_cache_24bit;
+
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        cache_stats.hits++;
+        return it->second;
+    }
+
+    cache_stats.misses++;
+    std::string code;
+    if (color_mode == RenderParams::COLOR_8BIT) {
+        int color = rgbTo8BitColorCached(r, g, b);
+        code = "\033[" + std::to_string(background ? 48 : 38) + ";5;" + std::to_string(color) + "m";
+    } else {
+        code = "\033[" + std::to_string(background ? 48 : 38) + ";2;" +
+               std::to_string(r) + ";" + std::to_string(g) + ";" + std::to_string(b) + "m";
+    }
+    if (cache_limit > 0 && cache.size() >= cache_limit) {
+        uncached_slot ^= 1;
+        uncached_codes[uncached_slot] = std::move(code);
+        return uncached_codes[uncached_slot];
+    }
+    std::string& stored = cache[key];
+    stored = std::move(code);
+    updateCacheSize();
+    return stored;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "cell_grid.hpp"
+
+struct RenderParams {
+    enum ColorMode {
+        MONO,        // Black and white
+        COLOR_8BIT,  // 256-color mode
+        COLOR_24BIT  // True color (RGB)
+    } color_mode = MONO;
+
+    int width = 0;            // target grid; 0 falls back to the default size
+    int height = 0;
+    bool block_mode = false;  // background-colored cells instead of characters
+    // Interlacing: 0 or 1 renders only the even or odd grid rows, each placed
+    // with an absolute cursor move (grid row 0 is screen row 1); -1 renders all
+    int field = -1;
+};
+
+// One frame of packed 8-bit BGR pixels owned by the caller
+struct PixelBuffer {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;        // bytes per row, 0 for tightly packed rows
+};
+
+// Converts BGR frames into ANSI text. There is no global state: each
+// renderer owns its color caches and scratch images, so use one renderer
+// per thread and reuse it across frames to avoid allocations.
+class AsciiRenderer {
+public:
+    static const int DEFAULT_WIDTH = 120;
+    static const int DEFAULT_HEIGHT = 40;
+
+    // Enhanced ASCII character set for better detail
+    static const std::string ASCII_CHARS;
+
+    // Cache statistics
+    struct CacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t cache_size = 0;
+
+        double hit_rate() const {
+            return (hits + misses > 0) ? (double)hits / (hits + misses) * 100.0 : 0.0;
+        }
+    };
+
+    AsciiRenderer();
+
+    // Cell grid a source of the given size is fitted into, keeping its aspect ratio
+    static cv::Size gridSize(int src_width, int src_height, int target_width, int target_height);
+
+    // Capacity that is always enough for render() of such a frame
+    static size_t maxOutputSize(const RenderParams& params, int src_width, int src_height);
+
+    // Render into caller-provided memory. Returns the number of bytes written,
+    // or 0 (writing nothing) if the frame is empty or `capacity` is smaller
+    // than maxOutputSize().
+    size_t render(const PixelBuffer& frame, const RenderParams& params, char* out, size_t capacity);
+
+    // Render frames back to back into `out`; lengths[i] receives the size of
+    // frame i. Empty frames (no data or no pixels) are skipped with a length
+    // of 0. Returns the total, or 0 if the output does not fit.
+    size_t renderBatch(const PixelBuffer* frames, size_t count, const RenderParams& params,
+                       char* out, size_t capacity, size_t* lengths);
+
+    // Convenience overloads; `out` keeps its capacity between calls
+    void render(const cv::Mat& frame, const RenderParams& params, std::string& out);
+    std::string render(const cv::Mat& frame, const RenderParams& params);
+
+    // The cells render() is meant to put on screen, for checking encoders.
+    // With a field set, rows of the other field keep their contents.
+    void renderCells(const cv::Mat& frame, const RenderParams& params, CellGrid& cells);
+
+    // Clear all caches (useful for memory management)
+    void clearCaches();
+    // Most entries each color cache grows to; 0 for no limit. Colors past
+    // the limit are converted every time they are used.
+    void setCacheLimit(size_t entries) { cache_limit = entries; }
+    size_t cacheLimit() const { return cache_limit; }
+    CacheStats cacheStats() const { return cache_stats; }
+    // Approximate heap bytes held by the caches and scratch images
+    size_t memoryUsage() const;
+
+private:
+    struct ColorKey {
+        uint8_t r, g, b;
+        bool background;
+
+        bool operator==(const ColorKey& other) const {
+            return r == other.r && g == other.g && b == other.b && background == other.background;
+        }
+    };
+
+    struct ColorKeyHasher {
+        std::size_t operator()(const ColorKey& k) const {
+            return ((std::size_t)k.r << 24) | ((std::size_t)k.g << 16) | ((std::size_t)k.b << 8) | (k.background ? 1 : 0);
+        }
+    };
+
+    size_t renderMat(const cv::Mat& frame, const RenderParams& params, char* out, size_t capacity);
+    void resizeToGrid(const cv::Mat& frame, const RenderParams& params);
+    char* writeMono(const cv::Mat& resized, int field, char* out);
+    char* writeColor(const cv::Mat& resized, bool background, int field, char* out);
+
+    void selectColorMode(RenderParams::ColorMode mode);
+    int rgbTo8BitColorCached(int r, int g, int b);
+    const std::string& getColorCodeCached(int r, int g, int b, bool background);
+    void updateCacheSize();
+
+    RenderParams::ColorMode color_mode = RenderParams::MONO;
+
+    // Color caches for different modes
+    std::unordered_map<ColorKey, std::string, ColorKeyHasher> color_cache_8bit;
+    std::unordered_map<ColorKey, std::string, ColorKeyHasher> color_cache_24bit;
+    std::unordered_map<uint32_t, int> rgb_to_8bit_cache; // RGB packed as uint32_t -> 8-bit color
+    CacheStats cache_stats;
+    size_t cache_limit = 0;
+    // Codes that didn't fit the cache; two, so the previous one a caller
+    // still compares against stays valid
+    std::string uncached_codes[2];
+    int uncached_slot = 0;
+
+    // Performance: Pre-computed brightness lookup table
+    int brightness_to_char_idx[256];
+
+    // Scratch images reused across frames
+    cv::Mat resized;
+    cv::Mat gray;
+    cv::Mat field_row;   // one grid row while interlacing
+};
@@ -0,0 +1,71 @@
+#include "buffer_depth.hpp"
+#include <algorithm>
+#include <cmath>
+
+BufferDepthController::BufferDepthController(size_t min_depth, size_t max_depth)
+    : min_depth(1), max_depth(1), current_depth(1) {
+    setLimits(min_depth, max_depth);
+}
+
+void BufferDepthController::setLimits(size_t min_d, size_t max_d) {
+    min_depth = std::max<size_t>(min_d, 1);
+    max_depth = std::max(max_d, min_depth);
+    reset();
+}
+
+void BufferDepthController::reset() {
+    mean_ms = 0.0;
+    var_ms = 0.0;
+    samples = 0;
+    margin = 0;
+    steady_frames = 0;
+    depth_sum = 0.0;
+    // Start in the middle so the first frames have some slack
+    current_depth = (min_depth + max_depth + 1) / 2;
+    pending_underruns = 0;
+    total_underruns = 0;
+}
+
+void BufferDepthController::addSample(double produce_ms, double frame_interval_ms) {
+    size_t underruns = pending_underruns.exchange(0);
+    if (underruns > 0) {
+        total_underruns += underruns;
+        margin = std::min(margin + 2 * underruns, max_depth);
+        steady_frames = 0;
+    }
+
+    // Exponentially weighted mean and variance of the production time
+    const double alpha = 0.1;
+    if (samples++ == 0) {
+        mean_ms = produce_ms;
+    } else {
+        double diff = produce_ms - mean_ms;
+        mean_ms += alpha * diff;
+        var_ms = (1.0 - alpha) * (var_ms + alpha * diff * diff);
+    }
+
+    // Frames needed to ride out a slow frame (three standard deviations)
+    size_t jitter_frames = 0;
+    if (frame_interval_ms > 0.0) {
+        double slow_ms = mean_ms + 3.0 * std::sqrt(var_ms);
+        jitter_frames = static_cast<size_t>(std::ceil(slow_ms / frame_interval_ms));
+    }
+    size_t wanted = std::min(std::max(jitter_frames + 1 + margin, min_depth), max_depth);
+
+    size_t depth = current_depth;
+    if (wanted > depth) {
+        // Grow at once: an underrun is worse than a bit of latency
+        depth = wanted;
+        steady_frames = 0;
+    } else if (++steady_frames >= SHRINK_AFTER) {
+        steady_frames = 0;
+        if (margin > 0) margin--;
+        if (wanted < depth) depth--;
+    }
+    current_depth = depth;
+    depth_sum += depth;
+}
+
+double BufferDepthController::averageDepth() const {
+    return samples > 0 ? depth_sum / samples : static_cast<double>(current_depth);
+}
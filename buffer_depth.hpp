@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Chooses how many frames to decode ahead. The depth covers the jitter in
+// the time it takes to produce a frame (decode + convert) plus a margin
+// that grows with every underrun. While the pipeline is steady the depth
+// drains back towards the minimum, so control changes show up sooner.
+// Samples come from the producer thread. noteUnderrun(), depth() and
+// underruns() may be called from any thread, averageDepth() once it stopped.
+class BufferDepthController {
+public:
+    BufferDepthController(size_t min_depth = 4, size_t max_depth = 16);
+
+    void setLimits(size_t min_depth, size_t max_depth);
+    size_t minDepth() const { return min_depth; }
+    size_t maxDepth() const { return max_depth; }
+    void reset();
+
+    // Time one frame took to produce, and the display interval it must meet
+    void addSample(double produce_ms, double frame_interval_ms);
+    // The display found the buffer empty
+    void noteUnderrun() { pending_underruns++; }
+
+    size_t depth() const { return current_depth; }
+    size_t underruns() const { return total_underruns; }
+    double averageDepth() const;
+
+private:
+    // Steady frames before the depth may shrink by one
+    static const int SHRINK_AFTER = 90;
+
+    size_t min_depth;
+    size_t max_depth;
+
+    double mean_ms = 0.0;
+    double var_ms = 0.0;
+    size_t samples = 0;
+    size_t margin = 0;       // extra frames from recent underruns
+    int steady_frames = 0;
+    double depth_sum = 0.0;
+
+    std::atomic<size_t> current_depth;
+    std::atomic<size_t> pending_underruns{0};
+    std::atomic<size_t> total_underruns{0};
+};
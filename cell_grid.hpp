@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Terminal cell contents independent of how they are encoded on the wire
+struct CellColor {
+    enum Kind : uint8_t {
+        DEFAULT,  // terminal's own foreground/background
+        INDEXED,  // 256-color palette entry
+        RGB       // 24-bit color
+    } kind = DEFAULT;
+    uint8_t index = 0;
+    uint8_t r = 0, g = 0, b = 0;
+
+    static CellColor indexed(int index) {
+        CellColor c;
+        c.kind = INDEXED;
+        c.index = static_cast<uint8_t>(index);
+        return c;
+    }
+
+    static CellColor rgb(int r, int g, int b) {
+        CellColor c;
+        c.kind = RGB;
+        c.r = static_cast<uint8_t>(r);
+        c.g = static_cast<uint8_t>(g);
+        c.b = static_cast<uint8_t>(b);
+        return c;
+    }
+
+    bool operator==(const CellColor& other) const {
+        if (kind != other.kind) return false;
+        if (kind == INDEXED) return index == other.index;
+        if (kind == RGB) return r == other.r && g == other.g && b == other.b;
+        return true;
+    }
+    bool operator!=(const CellColor& other) const { return !(*this == other); }
+};
+
+// xterm's color for a 256-color palette index, as RGB
+inline void xtermPaletteColor(int index, uint8_t rgb[3]) {
+    static const uint8_t BASIC[16][3] = {
+        {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0}, {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+        {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0}, {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255},
+    };
+    static const uint8_t CUBE_LEVELS[6] = {0, 95, 135, 175, 215, 255};
+    if (index < 16) {
+        for (int c = 0; c < 3; ++c) rgb[c] = BASIC[index][c];
+    } else if (index < 232) {
+        int i = index - 16;
+        rgb[0] = CUBE_LEVELS[i / 36];
+        rgb[1] = CUBE_LEVELS[(i / 6) % 6];
+        rgb[2] = CUBE_LEVELS[i % 6];
+    } else {
+        rgb[0] = rgb[1] = rgb[2] = static_cast<uint8_t>(8 + 10 * (index - 232));
+    }
+}
+
+// SGR parameters selecting a color, without the surrounding "\033[" and "m"
+inline void appendSgrColor(std::string& out, const CellColor& color, bool background) {
+    if (color.kind == CellColor::DEFAULT) {
+        out += background ? "49" : "39";
+    } else if (color.kind == CellColor::INDEXED) {
+        out += background ? "48;5;" : "38;5;";
+        out += std::to_string(color.index);
+    } else {
+        out += background ? "48;2;" : "38;2;";
+        out += std::to_string(color.r) + ";" + std::to_string(color.g) + ";" + std::to_string(color.b);
+    }
+}
+
+struct Cell {
+    char ch = ' ';
+    CellColor fg;
+    CellColor bg;
+
+    bool operator==(const Cell& other) const {
+        return ch == other.ch && fg == other.fg && bg == other.bg;
+    }
+    bool operator!=(const Cell& other) const { return !(*this == other); }
+};
+
+// Row-major grid of cells
+class CellGrid {
+public:
+    CellGrid() = default;
+    CellGrid(int width, int height) { resize(width, height); }
+
+    void resize(int new_width, int new_height) {
+        w = new_width > 0 ? new_width : 0;
+        h = new_height > 0 ? new_height : 0;
+        cells.assign(static_cast<size_t>(w) * h, Cell());
+    }
+
+    void clear(const Cell& fill = Cell()) { cells.assign(cells.size(), fill); }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    Cell& at(int x, int y) { return cells[static_cast<size_t>(y) * w + x]; }
+    const Cell& at(int x, int y) const { return cells[static_cast<size_t>(y) * w + x]; }
+    Cell* row(int y) { return &cells[static_cast<size_t>(y) * w]; }
+    const Cell* row(int y) const { return &cells[static_cast<size_t>(y) * w]; }
+
+    bool operator==(const CellGrid& other) const {
+        return w == other.w && h == other.h && cells == other.cells;
+    }
+    bool operator!=(const CellGrid& other) const { return !(*this == other); }
+
+private:
+    int w = 0;
+    int h = 0;
+    std::vector<Cell> cells;
+};
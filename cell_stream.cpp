@@ -0,0 +1,246 @@
+#include "cell_stream.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint8_t SET_PEN = 0x01;
+const uint8_t REPEAT = 0x02;
+
+enum ColorKind : uint8_t { UNCHANGED = 0, DEFAULT_COLOR = 1, PALETTE = 2, RGB_COLOR = 3 };
+
+void appendVarint(std::string& out, size_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+bool readVarint(const uint8_t*& p, const uint8_t* end, size_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint8_t colorKind(const CellColor& color, const CellColor& pen) {
+    if (color == pen) return UNCHANGED;
+    if (color.kind == CellColor::INDEXED) return PALETTE;
+    if (color.kind == CellColor::RGB) return RGB_COLOR;
+    return DEFAULT_COLOR;
+}
+
+void appendColor(std::string& out, const CellColor& color, uint8_t kind) {
+    if (kind == PALETTE) {
+        out += static_cast<char>(color.index);
+    } else if (kind == RGB_COLOR) {
+        out += static_cast<char>(color.r);
+        out += static_cast<char>(color.g);
+        out += static_cast<char>(color.b);
+    }
+}
+
+bool readColor(const uint8_t*& p, const uint8_t* end, uint8_t kind, CellColor& color) {
+    if (kind == DEFAULT_COLOR) {
+        color = CellColor();
+    } else if (kind == PALETTE) {
+        if (end - p < 1) return false;
+        color = CellColor::indexed(*p++);
+    } else if (kind == RGB_COLOR) {
+        if (end - p < 3) return false;
+        color = CellColor::rgb(p[0], p[1], p[2]);
+        p += 3;
+    }
+    return true;
+}
+
+} // namespace
+
+void CellStreamEncoder::appendHeader(std::string& out) {
+    out.append(cellstream::MAGIC, sizeof(cellstream::MAGIC));
+}
+
+void CellStreamEncoder::appendCells(const Cell* cells, size_t count, std::string& out) {
+    for (size_t i = 0; i < count; ++i) {
+        const Cell& cell = cells[i];
+        uint8_t fg_kind = colorKind(cell.fg, pen_fg);
+        uint8_t bg_kind = colorKind(cell.bg, pen_bg);
+        if (fg_kind != UNCHANGED || bg_kind != UNCHANGED) {
+            out += static_cast<char>(SET_PEN);
+            out += static_cast<char>(fg_kind | (bg_kind << 2));
+            appendColor(out, cell.fg, fg_kind);
+            appendColor(out, cell.bg, bg_kind);
+            pen_fg = cell.fg;
+            pen_bg = cell.bg;
+        }
+        // The two opcodes never appear as cell contents; renderers only draw printable characters
+        out += (cell.ch == SET_PEN || cell.ch == REPEAT) ? '?' : cell.ch;
+
+        size_t same = 0;
+        while (i + 1 + same < count && cells[i + 1 + same] == cell) same++;
+        if (same >= MIN_REPEAT) {
+            out += static_cast<char>(REPEAT);
+            appendVarint(out, same);
+            i += same;
+        }
+    }
+}
+
+void CellStreamEncoder::encode(const CellGrid& grid, std::string& out) {
+    bool keyframe = keyframe_wanted || grid.width() != previous.width() || grid.height() != previous.height();
+    const size_t total = static_cast<size_t>(grid.width()) * grid.height();
+    const Cell* now = total > 0 ? grid.row(0) : nullptr;
+    const Cell* before = !keyframe && total > 0 ? previous.row(0) : nullptr;
+    payload.clear();
+    pen_fg = CellColor();
+    pen_bg = CellColor();
+
+    if (keyframe) {
+        appendVarint(payload, static_cast<size_t>(grid.width()));
+        appendVarint(payload, static_cast<size_t>(grid.height()));
+        appendCells(now, total, payload);
+        totals.keyframes++;
+        totals.cells_changed += total;
+        keyframe_wanted = false;
+    } else {
+        size_t position = 0;   // first cell not yet covered by a run
+        size_t i = 0;
+        while (i < total) {
+            if (now[i] == before[i]) {
+                i++;
+                continue;
+            }
+            // A run of changes, carried across short unchanged gaps
+            size_t start = i, last_changed = i;
+            for (size_t j = i + 1; j < total && j - last_changed <= MERGE_GAP; ++j) {
+                if (now[j] != before[j]) {
+                    last_changed = j;
+                    totals.cells_changed++;
+                }
+            }
+            totals.cells_changed++;
+            appendVarint(payload, start - position);
+            appendVarint(payload, last_changed + 1 - start);
+            appendCells(now + start, last_changed + 1 - start, payload);
+            position = i = last_changed + 1;
+        }
+    }
+    previous = grid;
+
+    size_t start = out.size();
+    out += static_cast<char>(keyframe ? cellstream::KEYFRAME : cellstream::DELTA);
+    appendVarint(out, payload.size());
+    out += payload;
+    totals.frames++;
+    totals.bytes += out.size() - start;
+}
+
+void CellStreamDecoder::feed(const uint8_t* data, size_t size) {
+    // Drop what was parsed before growing the buffer
+    if (consumed > 0 && consumed >= buffer.size() / 2) {
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(consumed));
+        consumed = 0;
+    }
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+CellStreamDecoder::Result CellStreamDecoder::fail(const std::string& message) {
+    failure = message;
+    return FAILED;
+}
+
+bool CellStreamDecoder::decodeCells(const uint8_t*& p, const uint8_t* end, Cell* out, size_t count) {
+    size_t filled = 0;
+    while (filled < count) {
+        if (p >= end) return false;
+        uint8_t op = *p++;
+        if (op == SET_PEN) {
+            if (p >= end) return false;
+            uint8_t kinds = *p++;
+            if (!readColor(p, end, kinds & 0x03, pen_fg) || !readColor(p, end, (kinds >> 2) & 0x03, pen_bg)) {
+                return false;
+            }
+        } else if (op == REPEAT) {
+            size_t repeat;
+            if (filled == 0 || !readVarint(p, end, repeat) || repeat > count - filled) return false;
+            std::fill(out + filled, out + filled + repeat, last_cell);
+            filled += repeat;
+        } else {
+            last_cell.ch = static_cast<char>(op);
+            last_cell.fg = pen_fg;
+            last_cell.bg = pen_bg;
+            out[filled++] = last_cell;
+        }
+    }
+    return true;
+}
+
+CellStreamDecoder::Result CellStreamDecoder::next(CellGrid& grid) {
+    if (!failure.empty()) return FAILED;
+    while (true) {
+        const uint8_t* p = buffer.data() + consumed;
+        const uint8_t* end = buffer.data() + buffer.size();
+        if (!header_seen) {
+            if (end - p < static_cast<std::ptrdiff_t>(sizeof(cellstream::MAGIC))) return NEED_MORE;
+            if (std::memcmp(p, cellstream::MAGIC, sizeof(cellstream::MAGIC)) != 0) return fail("not a cell stream");
+            consumed += sizeof(cellstream::MAGIC);
+            header_seen = true;
+            continue;
+        }
+
+        if (p >= end) return NEED_MORE;
+        uint8_t type = *p++;
+        if (type != cellstream::KEYFRAME && type != cellstream::DELTA) return fail("unknown message type");
+        size_t length;
+        const uint8_t* length_start = p;
+        if (!readVarint(p, end, length)) {
+            // Incomplete unless it already ran past the longest varint
+            if (static_cast<size_t>(end - length_start) >= MAX_VARINT_BYTES) return fail("bad message length");
+            return NEED_MORE;
+        }
+        if (length > MAX_MESSAGE) return fail("message too long");
+        if (static_cast<size_t>(end - p) < length) return NEED_MORE;
+        const uint8_t* message_end = p + length;
+        consumed = static_cast<size_t>(message_end - buffer.data());
+        pen_fg = CellColor();
+        pen_bg = CellColor();
+
+        if (type == cellstream::KEYFRAME) {
+            size_t width, height;
+            // Each side is bounded first, so the product cannot wrap
+            if (!readVarint(p, message_end, width) || !readVarint(p, message_end, height) ||
+                width > MAX_SIDE || height > MAX_SIDE || width * height > MAX_CELLS) {
+                return fail("bad keyframe size");
+            }
+            grid.resize(static_cast<int>(width), static_cast<int>(height));
+            size_t total = width * height;
+            if (total > 0 && !decodeCells(p, message_end, grid.row(0), total)) return fail("truncated keyframe");
+            synced = true;
+            last_keyframe = true;
+            return FRAME;
+        }
+
+        // Deltas before the first keyframe (joined mid-stream) have nothing to apply to
+        if (!synced) continue;
+        const size_t total = static_cast<size_t>(grid.width()) * grid.height();
+        size_t position = 0;
+        while (p < message_end) {
+            size_t skip, count;
+            if (!readVarint(p, message_end, skip) || !readVarint(p, message_end, count) ||
+                skip > total - position || count > total - position - skip) {
+                return fail("delta outside the grid");
+            }
+            position += skip;
+            if (count > 0 && !decodeCells(p, message_end, grid.row(0) + position, count)) {
+                return fail("truncated delta");
+            }
+            position += count;
+        }
+        last_keyframe = false;
+        return FRAME;
+    }
+}
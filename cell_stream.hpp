@@ -0,0 +1,108 @@
+#pragma once
+#include "cell_grid.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary transport for cell grids, for viewers on another machine or
+// process that turn the cells into escapes for their own terminal. A color
+// costs 2 to 4 bytes instead of the 10 to 20 of an SGR sequence, and
+// unchanged cells and repeats cost next to nothing.
+//
+//   stream   := "TVC1" message*
+//   message  := type:u8 length:varint payload      (length of the payload)
+//   'K' key  := width:varint height:varint cells   (every cell, row-major)
+//   'D' delta:= (skip:varint count:varint cells)*  (runs of changed cells;
+//               skip counts unchanged cells since the previous run)
+//   cells    := 0x01 kinds:u8 [fg] [bg] | 0x02 n:varint | ch:u8
+//               0x01 sets the pen: kinds has the fg kind in bits 0-1 and
+//               the bg kind in bits 2-3 (0 unchanged, 1 default, 2 palette
+//               index, 1 byte, 3 RGB, 3 bytes); 0x02 repeats the previous
+//               cell n times; any other byte is a cell in the current pen
+//
+// Varints are LEB128. The pen starts as default/default in every message,
+// so a receiver can join at any keyframe. Receivers reject keyframes wider
+// or taller than 65535 cells, or with more than 4M cells.
+namespace cellstream {
+
+const char MAGIC[4] = {'T', 'V', 'C', '1'};
+const uint8_t KEYFRAME = 'K';
+const uint8_t DELTA = 'D';
+// A viewer sends this byte back (where the transport allows) to ask for a keyframe
+const uint8_t KEYFRAME_REQUEST = 'K';
+
+} // namespace cellstream
+
+class CellStreamEncoder {
+public:
+    struct Stats {
+        size_t frames = 0;
+        size_t keyframes = 0;
+        size_t cells_changed = 0;
+        size_t bytes = 0;
+    };
+
+    static void appendHeader(std::string& out);
+
+    // The next message redraws every cell (a new viewer, or one that lost track)
+    void requestKeyframe() { keyframe_wanted = true; }
+
+    // Appends one message that takes the viewer from the previous grid to
+    // `grid`: a keyframe for the first grid, a new size or on request
+    void encode(const CellGrid& grid, std::string& out);
+
+    const Stats& stats() const { return totals; }
+
+private:
+    // Unchanged cells this short between two changed runs are sent along;
+    // that is cheaper than closing the run and starting another
+    static const int MERGE_GAP = 2;
+    static const int MIN_REPEAT = 3;
+
+    void appendCells(const Cell* cells, size_t count, std::string& out);
+
+    CellGrid previous;
+    bool keyframe_wanted = true;
+    std::string payload;
+    CellColor pen_fg, pen_bg;
+    Stats totals;
+};
+
+// Rebuilds the grids from received bytes, which may arrive in any pieces
+class CellStreamDecoder {
+public:
+    enum Result {
+        NEED_MORE,   // no complete message buffered
+        FRAME,       // a message was applied to the grid
+        FAILED       // not a cell stream, or corrupt; see error()
+    };
+
+    void feed(const uint8_t* data, size_t size);
+    // Applies the next buffered message to `grid`
+    Result next(CellGrid& grid);
+
+    bool lastWasKeyframe() const { return last_keyframe; }
+    const std::string& error() const { return failure; }
+
+private:
+    static const size_t MAX_SIDE = 65535;
+    static const size_t MAX_CELLS = 1u << 22;
+    // Past any legal message (at most 9 bytes a cell, plus run headers), so
+    // a hostile length can't make the buffer grow without bound
+    static const size_t MAX_MESSAGE = MAX_CELLS * 16;
+    // Enough for any 64-bit value; more continuation bytes are corrupt
+    static const size_t MAX_VARINT_BYTES = 10;
+
+    bool decodeCells(const uint8_t*& p, const uint8_t* end, Cell* out, size_t count);
+    Result fail(const std::string& message);
+
+    std::vector<uint8_t> buffer;
+    size_t consumed = 0;
+    bool header_seen = false;
+    bool synced = false;      // a keyframe arrived, so deltas apply
+    bool last_keyframe = false;
+    Cell last_cell;
+    CellColor pen_fg, pen_bg;
+    std::string failure;
+};
@@ -0,0 +1,105 @@
+#include "crop_detector.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Pixels sampled along each border line
+const int LINE_SAMPLES = 64;
+// Fraction of samples allowed above the threshold (noise, stray subtitle pixels)
+const double BRIGHT_TOLERANCE = 0.02;
+// Detections closer than this are treated as the same crop
+const int MATCH_SLACK = 2;
+
+bool sameCrop(const cv::Rect& a, const cv::Rect& b) {
+    return std::abs(a.x - b.x) <= MATCH_SLACK && std::abs(a.y - b.y) <= MATCH_SLACK &&
+           std::abs(a.width - b.width) <= MATCH_SLACK && std::abs(a.height - b.height) <= MATCH_SLACK;
+}
+
+bool contains(const cv::Rect& outer, const cv::Rect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.width <= outer.x + outer.width &&
+           inner.y + inner.height <= outer.y + outer.height;
+}
+
+} // namespace
+
+CropDetector::CropDetector(int interval, int stable_samples, int threshold)
+    : interval(std::max(interval, 1)), stable_samples(std::max(stable_samples, 1)), threshold(threshold) {}
+
+void CropDetector::reset() {
+    frame_size = cv::Size();
+    crop = cv::Rect();
+    candidate = cv::Rect();
+    candidate_hits = 0;
+    frames_since_sample = 0;
+    locked = false;
+}
+
+cv::Rect CropDetector::update(const cv::Mat& frame) {
+    if (frame.size() != frame_size) {
+        // New source geometry: start over from the full frame
+        reset();
+        frame_size = frame.size();
+        crop = cv::Rect(0, 0, frame.cols, frame.rows);
+    }
+    
+    if (locked && ++frames_since_sample < interval) return crop;
+    frames_since_sample = 0;
+    
+    cv::Rect detected = detect(frame);
+    if (detected.empty()) return crop;
+    
+    if (!contains(detected, crop)) {
+        // Picture showed up inside the current bars; never cut it off
+        crop = crop | detected;
+        candidate = crop;
+        candidate_hits = 0;
+        return crop;
+    }
+    
+    if (sameCrop(detected, candidate)) {
+        candidate_hits++;
+    } else {
+        candidate = detected;
+        candidate_hits = 1;
+    }
+    if (candidate_hits >= stable_samples) {
+        crop = candidate;
+        locked = true;
+    }
+    return crop;
+}
+
+bool CropDetector::isDarkLine(const cv::Mat& frame, int index, bool row) const {
+    int length = row ? frame.cols : frame.rows;
+    int step = std::max(length / LINE_SAMPLES, 1);
+    int samples = 0, bright = 0;
+    for (int i = 0; i < length; i += step) {
+        const cv::Vec3b& p = row ? frame.at<cv::Vec3b>(index, i) : frame.at<cv::Vec3b>(i, index);
+        if (std::max({p[0], p[1], p[2]}) > threshold) bright++;
+        samples++;
+    }
+    return bright <= samples * BRIGHT_TOLERANCE;
+}
+
+cv::Rect CropDetector::detect(const cv::Mat& frame) const {
+    if (frame.empty() || frame.type() != CV_8UC3) return cv::Rect();
+    
+    int top = 0, bottom = frame.rows - 1;
+    while (top < frame.rows && isDarkLine(frame, top, true)) top++;
+    if (top == frame.rows) return cv::Rect(); // fade to black, nothing to learn
+    while (bottom > top && isDarkLine(frame, bottom, true)) bottom--;
+    
+    int left = 0, right = frame.cols - 1;
+    while (left < right && isDarkLine(frame, left, false)) left++;
+    while (right > left && isDarkLine(frame, right, false)) right--;
+    
+    // Keep even offsets and refuse implausible crops (mostly-dark scenes)
+    left &= ~1;
+    top &= ~1;
+    int width = right - left + 1;
+    int height = bottom - top + 1;
+    if (width < frame.cols / 2 || height < frame.rows / 2) return cv::Rect();
+    return cv::Rect(left, top, width, height);
+}
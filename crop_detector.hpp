@@ -0,0 +1,33 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Finds stable letterbox/pillarbox bars so they can be cropped off before
+// the resize. Border rows and columns are sampled every `interval` frames
+// (every frame until the first crop locks in). A tighter crop only takes
+// effect after `stable_samples` matching detections in a row. A looser one
+// is applied at once, because picture has appeared inside the old bars.
+class CropDetector {
+public:
+    explicit CropDetector(int interval = 12, int stable_samples = 3, int threshold = 24);
+    
+    // Feed a decoded frame; returns the region of it to render
+    cv::Rect update(const cv::Mat& frame);
+    cv::Rect current() const { return crop; }
+    void reset();
+    
+private:
+    // Content bounds of one frame, or an empty rect if it is too dark to tell
+    cv::Rect detect(const cv::Mat& frame) const;
+    bool isDarkLine(const cv::Mat& frame, int index, bool row) const;
+    
+    int interval;
+    int stable_samples;
+    int threshold;
+    
+    cv::Size frame_size;
+    cv::Rect crop;
+    cv::Rect candidate;
+    int candidate_hits = 0;
+    int frames_since_sample = 0;
+    bool locked = false;
+};
@@ -0,0 +1,187 @@
+#include "delta_encoder.hpp"
+#include "ascii_renderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char RESET_CODE[] = "\033[0m";
+const size_t RESET_LENGTH = sizeof(RESET_CODE) - 1;
+
+// Terminal defaults assumed for perceptual comparisons: light on black
+const float DEFAULT_FG[3] = {229, 229, 229};
+const float DEFAULT_BG[3] = {0, 0, 0};
+
+void toRgb(const CellColor& color, const float* fallback, float* rgb) {
+    if (color.kind == CellColor::RGB) {
+        rgb[0] = color.r;
+        rgb[1] = color.g;
+        rgb[2] = color.b;
+    } else if (color.kind == CellColor::INDEXED) {
+        uint8_t palette[3];
+        xtermPaletteColor(color.index, palette);
+        for (int c = 0; c < 3; ++c) rgb[c] = palette[c];
+    } else {
+        for (int c = 0; c < 3; ++c) rgb[c] = fallback[c];
+    }
+}
+
+// Average color a cell shows: its glyph's ramp position as ink coverage
+void perceivedColor(const Cell& cell, float* rgb) {
+    static const std::string& ramp = AsciiRenderer::ASCII_CHARS;
+    size_t pos = ramp.find(cell.ch);
+    float ink = (pos == std::string::npos) ? 0.5f : static_cast<float>(pos) / (ramp.size() - 1);
+    float fg[3], bg[3];
+    toRgb(cell.fg, DEFAULT_FG, fg);
+    toRgb(cell.bg, DEFAULT_BG, bg);
+    for (int c = 0; c < 3; ++c) rgb[c] = bg[c] + (fg[c] - bg[c]) * ink;
+}
+
+// Luma-weighted color distance, plus a little for changed structure
+double cellDifference(const Cell& a, const Cell& b) {
+    float pa[3], pb[3];
+    perceivedColor(a, pa);
+    perceivedColor(b, pb);
+    double dr = pa[0] - pb[0], dg = pa[1] - pb[1], db = pa[2] - pb[2];
+    double d = std::sqrt(0.299 * dr * dr + 0.587 * dg * dg + 0.114 * db * db);
+    return d + (a.ch != b.ch ? 8.0 : 0.0);
+}
+
+} // namespace
+
+void DeltaEncoder::appendRegion(const CellGrid& target, const Region& region, bool fresh_pen, std::string& out) {
+    out += "\033[" + std::to_string(region.y + 1) + ";" + std::to_string(region.x0 + 1) + "H";
+    const Cell* row = target.row(region.y);
+    for (int x = region.x0; x <= region.x1; ++x) {
+        const Cell& cell = row[x];
+        // For cost estimates every region starts with both colors set
+        bool set_fg = cell.fg != pen_fg || (fresh_pen && x == region.x0);
+        bool set_bg = cell.bg != pen_bg || (fresh_pen && x == region.x0);
+        if (set_fg || set_bg) {
+            out += "\033[";
+            if (set_fg) appendSgrColor(out, cell.fg, false);
+            if (set_fg && set_bg) out += ';';
+            if (set_bg) appendSgrColor(out, cell.bg, true);
+            out += 'm';
+            pen_fg = cell.fg;
+            pen_bg = cell.bg;
+        }
+        out += cell.ch;
+    }
+}
+
+bool DeltaEncoder::trimToFit(const CellGrid& target, Region& region, size_t room) {
+    CellColor fg = pen_fg, bg = pen_bg;
+    Region prefix = region;
+    std::string scratch;
+    bool fits = false;
+    for (int x = region.x0; x < region.x1; ++x) {
+        prefix.x1 = x;
+        scratch.clear();
+        appendRegion(target, prefix, true, scratch);
+        pen_fg = fg;
+        pen_bg = bg;
+        if (scratch.size() > room) break;
+        region.x1 = x;
+        region.cost = scratch.size();
+        fits = true;
+    }
+    return fits;
+}
+
+void DeltaEncoder::encode(const CellGrid& target, std::string& out) {
+    size_t start = out.size();
+    stats = Stats();
+
+    // New geometry or unknown screen: clear and start from blank cells
+    if (!valid || shown.width() != target.width() || shown.height() != target.height()) {
+        out += RESET_CODE;
+        out += "\033[2J";
+        shown.resize(target.width(), target.height());
+        age.assign(static_cast<size_t>(target.width()) * target.height(), 0);
+        pen_fg = CellColor();
+        pen_bg = CellColor();
+        valid = true;
+    }
+
+    // Collect changed runs, scored by perceptual difference times waiting time
+    regions.clear();
+    for (int y = 0; y < target.height(); ++y) {
+        const Cell* want = target.row(y);
+        const Cell* have = shown.row(y);
+        uint16_t* waiting = &age[static_cast<size_t>(y) * target.width()];
+        Region current;
+        bool open = false;
+        int last_changed = -1;
+        for (int x = 0; x < target.width(); ++x) {
+            if (want[x] == have[x]) {
+                waiting[x] = 0;
+                continue;
+            }
+            stats.cells_changed++;
+            double score = cellDifference(want[x], have[x]) * (1.0 + waiting[x] / 4.0);
+            if (waiting[x] < 0xffff) waiting[x]++;
+
+            bool extend = open && x - last_changed <= MERGE_GAP + 1 && x - current.x0 < MAX_REGION_CELLS;
+            if (!extend) {
+                if (open) regions.push_back(current);
+                current = Region();
+                current.y = y;
+                current.x0 = x;
+                open = true;
+            }
+            current.x1 = x;
+            current.score += score;
+            last_changed = x;
+        }
+        if (open) regions.push_back(current);
+    }
+
+    // Most important first; smaller regions further down may still fit
+    std::string scratch;
+    size_t reserve = RESET_LENGTH;
+    size_t spent = out.size() - start;
+    for (auto& region : regions) {
+        scratch.clear();
+        CellColor fg = pen_fg, bg = pen_bg;
+        appendRegion(target, region, true, scratch);
+        pen_fg = fg;
+        pen_bg = bg;
+        region.cost = scratch.size();
+    }
+    std::stable_sort(regions.begin(), regions.end(),
+                     [](const Region& a, const Region& b) { return a.score > b.score; });
+
+    size_t chosen = 0;
+    for (auto& region : regions) {
+        if (budget > 0 && spent + region.cost + reserve > budget) {
+            stats.regions_deferred++;
+            // Send the cells that fit and leave the rest for later; otherwise
+            // a region costing more than the whole budget would never go out
+            if (spent + reserve >= budget || !trimToFit(target, region, budget - spent - reserve)) continue;
+        }
+        spent += region.cost;
+        std::swap(regions[chosen++], region);
+    }
+
+    // Send in screen order so the cursor mostly moves forward
+    std::sort(regions.begin(), regions.begin() + chosen, [](const Region& a, const Region& b) {
+        return a.y != b.y ? a.y < b.y : a.x0 < b.x0;
+    });
+    for (size_t i = 0; i < chosen; ++i) {
+        const Region& region = regions[i];
+        appendRegion(target, region, false, out);
+        for (int x = region.x0; x <= region.x1; ++x) {
+            shown.at(x, region.y) = target.at(x, region.y);
+            age[static_cast<size_t>(region.y) * target.width() + x] = 0;
+            stats.cells_sent++;
+        }
+        stats.regions_sent++;
+    }
+    if (pen_fg.kind != CellColor::DEFAULT || pen_bg.kind != CellColor::DEFAULT) {
+        out += RESET_CODE;
+        pen_fg = CellColor();
+        pen_bg = CellColor();
+    }
+    stats.bytes = out.size() - start;
+}
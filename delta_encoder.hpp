@@ -0,0 +1,63 @@
+#pragma once
+#include "cell_grid.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Encodes a cell grid as updates against what the terminal already shows:
+// only changed cells are sent, as absolute cursor moves plus runs of cells.
+// With a byte budget, the changed regions are ranked by how different they
+// look and sent most important first. Whatever does not fit stays pending
+// and competes again on the next frame with a priority that grows every
+// frame it waits, so a constrained link converges instead of freezing.
+class DeltaEncoder {
+public:
+    struct Stats {
+        size_t cells_changed = 0;     // cells that differed from the screen
+        size_t cells_sent = 0;
+        size_t regions_sent = 0;
+        size_t regions_deferred = 0;  // left for a later frame
+        size_t bytes = 0;
+    };
+
+    // Bytes per frame, 0 for no limit
+    void setBudget(size_t bytes) { budget = bytes; }
+    size_t getBudget() const { return budget; }
+
+    // Forget the screen contents; the next frame clears and redraws
+    void reset() { valid = false; }
+
+    // Appends to `out` the bytes that move the screen towards `target`.
+    // The grid is drawn from the top-left corner of the screen.
+    void encode(const CellGrid& target, std::string& out);
+
+    // What the terminal shows after the bytes produced so far
+    const CellGrid& screen() const { return shown; }
+    const Stats& lastStats() const { return stats; }
+
+private:
+    struct Region {
+        int y = 0;
+        int x0 = 0, x1 = 0;    // inclusive
+        double score = 0.0;
+        size_t cost = 0;       // upper bound on its encoded size
+    };
+
+    // Regions are runs of changed cells, merged across short gaps and split
+    // so that any one of them fits a small budget
+    static const int MERGE_GAP = 3;
+    static const int MAX_REGION_CELLS = 16;
+
+    void appendRegion(const CellGrid& target, const Region& region, bool fresh_pen, std::string& out);
+    // Shortens the region to the cells that fit in `room` bytes; false if not even one does
+    bool trimToFit(const CellGrid& target, Region& region, size_t room);
+
+    size_t budget = 0;
+    bool valid = false;
+    CellGrid shown;
+    std::vector<uint16_t> age;   // frames each pending cell has waited
+    CellColor pen_fg, pen_bg;
+    std::vector<Region> regions;
+    Stats stats;
+};
@@ -0,0 +1,78 @@
+#include "frame_source.hpp"
+#include "jpeg_source.hpp"
+#include "gif_source.hpp"
+#include "animation_cache.hpp"
+#include <algorithm>
+
+std::unique_ptr<FrameSource> FrameSource::open(const std::string& path, bool use_cache) {
+    // Short animations are decoded once and then played from memory
+    if (use_cache) {
+        if (auto cached = AnimationCache::open(path)) return cached;
+    }
+    // JPEG frames can be decoded straight to a fraction of their size
+    if (ImageSequenceSource::isSequencePath(path)) {
+        auto sequence = ImageSequenceSource::open(path);
+        if (use_cache && sequence && sequence->frameCount() <= AnimationCache::MAX_SEQUENCE_FRAMES) {
+            return AnimationCache::record(path, std::move(sequence));
+        }
+        return sequence;
+    }
+    if (GifSource::isGifPath(path)) {
+        if (auto gif = GifSource::open(path)) {
+            if (!use_cache) return gif;
+            return AnimationCache::record(path, std::move(gif));
+        }
+    }
+    auto capture = std::make_unique<CaptureSource>(path);
+    if (!capture->isOpened()) return nullptr;
+    if (capture->isMotionJpeg()) {
+        if (auto mjpeg = MjpegSource::open(path)) return mjpeg;
+    }
+    return capture;
+}
+
+CaptureSource::CaptureSource(const std::string& path) {
+    // Started first, so the backend's probing reads already hit the cache
+    readahead.start(path);
+    cap.open(path);
+}
+
+bool CaptureSource::read(cv::Mat& frame) {
+    if (!cap.read(frame)) return false;
+    int count = frameCount();
+    if (count > 0) readahead.setProgress(static_cast<double>(++frames_read) / count);
+    return true;
+}
+
+bool CaptureSource::seek(double ms) {
+    if (!cap.set(cv::CAP_PROP_POS_MSEC, std::max(ms, 0.0))) return false;
+    // The readahead follows the jump
+    int count = frameCount();
+    frames_read = static_cast<int>(ms * std::max(fps(), 0.0) / 1000.0);
+    if (count > 0) readahead.setProgress(static_cast<double>(frames_read) / count);
+    return true;
+}
+
+bool CaptureSource::isMotionJpeg() const {
+    return static_cast<int>(cap.get(cv::CAP_PROP_FOURCC)) == cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+}
+
+double CaptureSource::timestamp() const {
+    return cap.get(cv::CAP_PROP_POS_MSEC);
+}
+
+double CaptureSource::fps() const {
+    return cap.get(cv::CAP_PROP_FPS);
+}
+
+int CaptureSource::frameCount() const {
+    return static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+}
+
+int CaptureSource::frameWidth() const {
+    return static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
+}
+
+int CaptureSource::frameHeight() const {
+    return static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+}
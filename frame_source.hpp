@@ -0,0 +1,57 @@
+#pragma once
+#include "input_io.hpp"
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+
+// A stream of decoded BGR frames. Sources are not thread-safe: each one is
+// read by a single thread at a time.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    
+    virtual bool read(cv::Mat& frame) = 0;
+    // Presentation time in ms of the frame last read, negative if unknown
+    virtual double timestamp() const = 0;
+    virtual double fps() const = 0;
+    virtual int frameCount() const = 0;
+    virtual int frameWidth() const = 0;
+    virtual int frameHeight() const = 0;
+    
+    // Size in pixels the frames will be scaled down to. Sources that can
+    // decode at reduced size may return smaller frames, but never smaller
+    // than this. Called from the reading thread.
+    virtual void setTargetSize(int width, int height) { (void)width; (void)height; }
+    
+    // Moves to the frame showing source time `ms` (the timestamp() scale),
+    // or the closest one the source can reach; read() continues from there.
+    // False, with the position unchanged, if the source can't seek.
+    virtual bool seek(double ms) { (void)ms; return false; }
+    
+    // Open the best available source for a path, or nullptr on failure.
+    // Without `use_cache` short animations are neither played from nor
+    // kept in the animation cache (for readers besides the player's own).
+    static std::unique_ptr<FrameSource> open(const std::string& path, bool use_cache = true);
+};
+
+// Anything cv::VideoCapture can decode. Local and mounted files are read
+// ahead of the backend, which does its own small reads.
+class CaptureSource : public FrameSource {
+public:
+    explicit CaptureSource(const std::string& path);
+    
+    bool isOpened() const { return cap.isOpened(); }
+    bool isMotionJpeg() const;
+    bool read(cv::Mat& frame) override;
+    double timestamp() const override;
+    double fps() const override;
+    int frameCount() const override;
+    int frameWidth() const override;
+    int frameHeight() const override;
+    bool seek(double ms) override;
+    
+private:
+    Readahead readahead;
+    cv::VideoCapture cap;
+    int frames_read = 0;
+};
@@ -0,0 +1,90 @@
+#include "frame_timing.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double MIN_FPS = 1.0;
+const double MAX_FPS = 240.0;
+const double FALLBACK_INTERVAL_MS = 1000.0 / 30.0;
+
+} // namespace
+
+bool plausibleFrameRate(double fps) {
+    return std::isfinite(fps) && fps >= MIN_FPS && fps <= MAX_FPS;
+}
+
+double nominalFrameInterval(double fps) {
+    return plausibleFrameRate(fps) ? 1000.0 / fps : FALLBACK_INTERVAL_MS;
+}
+
+void FrameTimestamps::reset(double nominal_interval_ms) {
+    started = resync = false;
+    first_ms = last_source_ms = media_ms = 0.0;
+    typical_ms = nominal_interval_ms > 0.0 ? nominal_interval_ms : FALLBACK_INTERVAL_MS;
+}
+
+double FrameTimestamps::next(double timestamp_ms) {
+    bool known = std::isfinite(timestamp_ms) && timestamp_ms >= 0.0;
+    if (!started) {
+        started = true;
+        first_ms = last_source_ms = known ? timestamp_ms : 0.0;
+        media_ms = 0.0;
+        return media_ms;
+    }
+
+    if (resync) {
+        resync = false;
+        if (known) last_source_ms = timestamp_ms;
+        media_ms = known ? std::max(timestamp_ms - first_ms, 0.0) : media_ms;
+        return media_ms;
+    }
+
+    double step = known ? timestamp_ms - last_source_ms : -1.0;
+    if (step > 0.0 && step <= MAX_STEP_MS) {
+        // Slow average, so one long still frame doesn't change the fallback much
+        typical_ms += (std::min(step, 4.0 * typical_ms) - typical_ms) * 0.05;
+        media_ms += step;
+    } else {
+        media_ms += typical_ms;
+    }
+    if (known) last_source_ms = timestamp_ms;
+    return media_ms;
+}
+
+void FrameTimestamps::seek(double media) {
+    if (!started) return;
+    resync = true;
+    media_ms = std::max(media, 0.0);
+}
+
+void PresentationClock::setSpeed(double speed) {
+    if (speed <= 0.0 || speed == rate) return;
+    // Keep the last frame where it was and scale the schedule from there
+    anchor_wall_ms = last_due_ms;
+    anchor_media_ms = last_media_ms;
+    rate = speed;
+}
+
+void PresentationClock::join(double media_ms, double gap_ms) {
+    if (!anchored) return;
+    anchor_wall_ms = last_due_ms + gap_ms / rate;
+    anchor_media_ms = last_media_ms = media_ms;
+}
+
+double PresentationClock::due(double media_ms, double now_ms) {
+    // A frame earlier than the last one means a new timeline (next item or loop)
+    if (anchored && media_ms < last_media_ms) anchored = false;
+    if (anchored) {
+        double when = anchor_wall_ms + (media_ms - anchor_media_ms) / rate;
+        if (now_ms - when <= MAX_LAG_MS) {
+            last_media_ms = media_ms;
+            last_due_ms = when;
+            return when;
+        }
+    }
+    anchored = true;
+    anchor_wall_ms = last_due_ms = now_ms;
+    anchor_media_ms = last_media_ms = media_ms;
+    return now_ms;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// Frame rates outside this range are container artifacts (a time base
+// reported as the rate, 0 for variable-rate streams) rather than real rates
+double nominalFrameInterval(double fps);
+bool plausibleFrameRate(double fps);
+
+// Turns the timestamps a source reports into a clean media timeline for
+// one playlist item. Missing, repeated, backwards or wildly large steps
+// are replaced by the typical interval, which is learned from the good
+// steps, so a few broken packets cost one frame of timing, not a stall.
+// Used by the decoding thread only.
+class FrameTimestamps {
+public:
+    explicit FrameTimestamps(double nominal_interval_ms = 33.33) { reset(nominal_interval_ms); }
+
+    // Start of a new item; `nominal_interval_ms` covers frames without timestamps
+    void reset(double nominal_interval_ms);
+
+    // Media time of the next frame in ms from the item's first frame.
+    // `timestamp_ms` is what the source reported, negative for none.
+    double next(double timestamp_ms);
+
+    // The source jumped to media time `media_ms`; the next frame's own
+    // timestamp places it (relative to the first frame) when it has one
+    void seek(double media_ms);
+
+    // Typical frame interval seen so far
+    double interval() const { return typical_ms; }
+    // Source time of the item's first frame, once one was seen
+    bool hasOrigin() const { return started; }
+    double origin() const { return first_ms; }
+
+private:
+    // Longest believable pause between two frames (still scenes in screen
+    // recordings get long ones); beyond that the timestamp is treated as broken
+    static constexpr double MAX_STEP_MS = 10000.0;
+
+    bool started = false;
+    bool resync = false;        // after a seek
+    double first_ms = 0.0;      // source time of the item's first frame
+    double last_source_ms = 0.0;
+    double media_ms = 0.0;
+    double typical_ms = 33.33;
+};
+
+// When each frame goes on screen: at its media time, relative to an anchor
+// frame, scaled by the playback speed. The anchor moves whenever the
+// timeline is interrupted (start, pause, new item, falling too far behind)
+// or the speed changes, so no interruption is made up for with a burst of frames.
+class PresentationClock {
+public:
+    // Next frame becomes the anchor
+    void restart() { anchored = false; }
+    // A new timeline (next playlist item, loop) whose first frame, at
+    // `media_ms`, follows the previous frame after `gap_ms` of media time
+    void join(double media_ms, double gap_ms);
+    void setSpeed(double speed);
+    double speed() const { return rate; }
+
+    // Wall time (ms) at which a frame of media time `media_ms` is due.
+    // Anchors on this frame if needed, using `now_ms` as its due time.
+    double due(double media_ms, double now_ms);
+
+private:
+    // Later than this and the schedule restarts from the current frame
+    static constexpr double MAX_LAG_MS = 250.0;
+
+    bool anchored = false;
+    double anchor_wall_ms = 0.0;
+    double anchor_media_ms = 0.0;
+    double last_media_ms = 0.0;
+    double last_due_ms = 0.0;
+    double rate = 1.0;
+};
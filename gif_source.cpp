@@ -0,0 +1,106 @@
+#include "gif_source.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// Browsers treat delays this short as "unspecified"
+const int MIN_DELAY_CS = 2;
+const double DEFAULT_DELAY_MS = 100.0;
+
+// Skips a chain of data sub-blocks; false if the data ends first
+bool skipSubBlocks(const uint8_t* data, size_t size, size_t& pos) {
+    while (pos < size) {
+        uint8_t length = data[pos++];
+        if (length == 0) return true;
+        pos += length;
+    }
+    return false;
+}
+
+size_t colorTableBytes(uint8_t packed) {
+    return (packed & 0x80) ? 3u * (2u << (packed & 0x07)) : 0u;
+}
+
+} // namespace
+
+bool GifSource::isGifPath(const std::string& path) {
+    if (path.size() < 4) return false;
+    std::string ext = path.substr(path.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".gif";
+}
+
+bool GifSource::readFrameDelays(const std::string& path, std::vector<double>& delays_ms, int* width, int* height) {
+    InputFile file;
+    if (!file.open(path, IoStats::OPEN)) return false;
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    if (size < 13 || data[0] != 'G' || data[1] != 'I' || data[2] != 'F') return false;
+
+    // Logical screen descriptor, then the optional global color table
+    if (width) *width = data[6] | (data[7] << 8);
+    if (height) *height = data[8] | (data[9] << 8);
+    size_t pos = 13 + colorTableBytes(data[10]);
+
+    delays_ms.clear();
+    int pending_delay_cs = -1;
+    while (pos < size) {
+        uint8_t block = data[pos++];
+        if (block == 0x3B) break;  // trailer
+        if (block == 0x21) {
+            if (pos >= size) break;
+            uint8_t label = data[pos++];
+            // Graphic control extension: size 4, flags, delay (LE), transparent index
+            if (label == 0xF9 && pos + 5 <= size && data[pos] == 4) {
+                pending_delay_cs = data[pos + 2] | (data[pos + 3] << 8);
+            }
+            if (!skipSubBlocks(data, size, pos)) break;
+        } else if (block == 0x2C) {
+            // Image descriptor, local color table, LZW code size, image data
+            if (pos + 9 > size) break;
+            pos += 9 + colorTableBytes(data[pos + 8]);
+            pos++;
+            delays_ms.push_back(pending_delay_cs >= MIN_DELAY_CS ? pending_delay_cs * 10.0 : DEFAULT_DELAY_MS);
+            pending_delay_cs = -1;
+            if (!skipSubBlocks(data, size, pos)) break;
+        } else {
+            break;  // not a block we know; keep the frames found so far
+        }
+    }
+    return !delays_ms.empty();
+}
+
+std::unique_ptr<GifSource> GifSource::open(const std::string& path) {
+    std::unique_ptr<GifSource> source(new GifSource());
+    if (!readFrameDelays(path, source->delays, &source->width, &source->height)) return nullptr;
+    if (!source->cap.open(path) || !source->cap.isOpened()) return nullptr;
+    return source;
+}
+
+bool GifSource::read(cv::Mat& frame) {
+    if (!cap.read(frame)) return false;
+    last_timestamp = next_timestamp;
+    // Frames the parser didn't see (a truncated file) keep the last delay
+    double delay = delays.empty() ? DEFAULT_DELAY_MS : delays[std::min(next_frame, delays.size() - 1)];
+    next_timestamp += delay;
+    next_frame++;
+    return true;
+}
+
+double GifSource::fps() const {
+    double total = 0.0;
+    for (double delay : delays) total += delay;
+    return total > 0.0 ? 1000.0 * delays.size() / total : 0.0;
+}
+
+bool GifSource::seek(double ms) {
+    // The frame on screen at `ms`: the last one starting at or before it
+    size_t frame = 0;
+    double start = 0.0;
+    while (frame + 1 < delays.size() && start + delays[frame] <= ms) start += delays[frame++];
+    if (!cap.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(frame))) return false;
+    next_frame = frame;
+    next_timestamp = start;
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "frame_source.hpp"
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Animated GIF: cv::VideoCapture decodes the pictures, but the per-frame
+// delays come from the file's Graphic Control Extensions, which capture
+// backends either ignore or round to a constant rate.
+class GifSource : public FrameSource {
+public:
+    // Delay of every frame in ms, as browsers show them (0 and 10 ms become
+    // 100 ms); false if the file is not a GIF
+    static bool readFrameDelays(const std::string& path, std::vector<double>& delays_ms,
+                                int* width = nullptr, int* height = nullptr);
+    static bool isGifPath(const std::string& path);
+
+    // nullptr if the file can't be parsed or decoded
+    static std::unique_ptr<GifSource> open(const std::string& path);
+
+    bool read(cv::Mat& frame) override;
+    double timestamp() const override { return last_timestamp; }
+    double fps() const override;
+    int frameCount() const override { return static_cast<int>(delays.size()); }
+    int frameWidth() const override { return width; }
+    int frameHeight() const override { return height; }
+    bool seek(double ms) override;
+
+private:
+    cv::VideoCapture cap;
+    std::vector<double> delays;
+    size_t next_frame = 0;
+    double next_timestamp = 0.0;
+    double last_timestamp = -1.0;
+    int width = 0;
+    int height = 0;
+};
@@ -0,0 +1,118 @@
+#include "glyph_atlas.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+GlyphAtlas::GlyphAtlas(int cell_width, int cell_height)
+    : cell_w(std::max(cell_width, 4)), cell_h(std::max(cell_height, 6)) {
+    buildMasks();
+}
+
+void GlyphAtlas::buildMasks() {
+    // OpenCV's built-in Hershey font, scaled so capitals fill most of a cell
+    const int font = cv::FONT_HERSHEY_PLAIN;
+    int baseline = 0;
+    cv::Size unit = cv::getTextSize("M", font, 1.0, 1, &baseline);
+    double scale = std::min((cell_w - 1) / static_cast<double>(std::max(unit.width, 1)),
+                            (cell_h * 0.6) / std::max(unit.height, 1));
+    int cap_height = static_cast<int>(unit.height * scale + 0.5);
+    int descent = static_cast<int>(baseline * scale + 0.5);
+    int origin_y = std::min((cell_h + cap_height) / 2, cell_h - 1 - descent / 2);
+
+    int glyphs = LAST_GLYPH - FIRST_GLYPH + 1;
+    size_t glyph_bytes = static_cast<size_t>(cell_w) * 3 * cell_h;
+    masks.assign(glyph_bytes * glyphs, 0);
+    blank.assign(glyphs, true);
+
+    cv::Mat mask(cell_h, cell_w, CV_8UC1);
+    for (int g = 0; g < glyphs; ++g) {
+        std::string text(1, static_cast<char>(FIRST_GLYPH + g));
+        mask.setTo(cv::Scalar(0));
+        cv::Size size = cv::getTextSize(text, font, scale, 1, &baseline);
+        int origin_x = std::max((cell_w - size.width) / 2, 0);
+        cv::putText(mask, text, cv::Point(origin_x, origin_y), font, scale, cv::Scalar(255), 1, cv::LINE_AA);
+
+        uint8_t* out = &masks[glyph_bytes * g];
+        for (int y = 0; y < cell_h; ++y) {
+            const uint8_t* in = mask.ptr<uint8_t>(y);
+            for (int x = 0; x < cell_w; ++x) {
+                if (in[x]) blank[g] = false;
+                out[x * 3] = out[x * 3 + 1] = out[x * 3 + 2] = in[x];
+            }
+            out += cell_w * 3;
+        }
+    }
+}
+
+void GlyphAtlas::setDefaultColors(const uint8_t fg[3], const uint8_t bg[3]) {
+    std::memcpy(default_fg, fg, 3);
+    std::memcpy(default_bg, bg, 3);
+}
+
+void GlyphAtlas::resolve(const CellColor& color, const uint8_t* fallback, uint8_t* bgr) const {
+    uint8_t rgb[3];
+    if (color.kind == CellColor::RGB) {
+        rgb[0] = color.r;
+        rgb[1] = color.g;
+        rgb[2] = color.b;
+    } else if (color.kind == CellColor::INDEXED) {
+        xtermPaletteColor(color.index, rgb);
+    } else {
+        std::memcpy(rgb, fallback, 3);
+    }
+    bgr[0] = rgb[2];
+    bgr[1] = rgb[1];
+    bgr[2] = rgb[0];
+}
+
+void GlyphAtlas::rasterize(const CellGrid& cells, cv::Mat& image) const {
+    cv::Size size = imageSize(cells);
+    if (image.rows != size.height || image.cols != size.width || image.type() != CV_8UC3) {
+        image.create(size.height, size.width, CV_8UC3);
+    }
+    cv::parallel_for_(cv::Range(0, cells.height()), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) drawRow(cells, y, image);
+    });
+}
+
+void GlyphAtlas::drawRow(const CellGrid& cells, int y, cv::Mat& image) const {
+    const int span = cell_w * 3;
+    const size_t glyph_bytes = static_cast<size_t>(span) * cell_h;
+    // One cell's colors repeated across its width, so the blend runs over plain bytes.
+    // Per thread, so rows drawn in parallel share nothing and allocate only once.
+    thread_local std::vector<uint8_t> fg_row, bg_row;
+    fg_row.resize(span);
+    bg_row.resize(span);
+    const Cell* row = cells.row(y);
+
+    for (int x = 0; x < cells.width(); ++x) {
+        const Cell& cell = row[x];
+        uint8_t fg[3], bg[3];
+        resolve(cell.fg, default_fg, fg);
+        resolve(cell.bg, default_bg, bg);
+        int g = static_cast<unsigned char>(cell.ch) - FIRST_GLYPH;
+        bool solid = g < 0 || g > LAST_GLYPH - FIRST_GLYPH || blank[g] ||
+                     (fg[0] == bg[0] && fg[1] == bg[1] && fg[2] == bg[2]);
+        for (int i = 0; i < span; i += 3) {
+            std::memcpy(&fg_row[i], fg, 3);
+            std::memcpy(&bg_row[i], bg, 3);
+        }
+
+        for (int py = 0; py < cell_h; ++py) {
+            uint8_t* dst = image.ptr<uint8_t>(y * cell_h + py) + x * span;
+            if (solid) {
+                std::memcpy(dst, bg_row.data(), span);
+                continue;
+            }
+            const uint8_t* alpha = &masks[glyph_bytes * g + static_cast<size_t>(py) * span];
+            const uint8_t* f = fg_row.data();
+            const uint8_t* b = bg_row.data();
+            for (int i = 0; i < span; ++i) {
+                // (f * a + b * (255 - a)) / 255, rounded, in 16 bits
+                uint16_t v = static_cast<uint16_t>(f[i] * alpha[i] + b[i] * (255 - alpha[i]) + 128);
+                dst[i] = static_cast<uint8_t>((v + (v >> 8)) >> 8);
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "cell_grid.hpp"
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Turns cell grids back into pixels, the way a terminal would draw them.
+// Printable ASCII is rasterized once into coverage masks of one cell each;
+// drawing a cell is then a blend of its background and foreground through
+// the mask, with no font work per frame. Masks store coverage once per BGR
+// channel so a glyph row blends as one contiguous byte run, which the
+// compiler vectorizes. Cell rows are drawn in parallel.
+class GlyphAtlas {
+public:
+    static const int DEFAULT_CELL_WIDTH = 8;
+    static const int DEFAULT_CELL_HEIGHT = 16;
+
+    explicit GlyphAtlas(int cell_width = DEFAULT_CELL_WIDTH, int cell_height = DEFAULT_CELL_HEIGHT);
+
+    int cellWidth() const { return cell_w; }
+    int cellHeight() const { return cell_h; }
+    cv::Size imageSize(const CellGrid& cells) const {
+        return cv::Size(cells.width() * cell_w, cells.height() * cell_h);
+    }
+
+    // Colors shown for CellColor::DEFAULT, as RGB; light on black by default
+    void setDefaultColors(const uint8_t fg[3], const uint8_t bg[3]);
+
+    // Replaces `image` with the grid drawn as 8-bit BGR
+    void rasterize(const CellGrid& cells, cv::Mat& image) const;
+
+    size_t memoryUsage() const { return masks.size(); }
+
+private:
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+
+    void buildMasks();
+    void drawRow(const CellGrid& cells, int y, cv::Mat& image) const;
+    void resolve(const CellColor& color, const uint8_t* fallback, uint8_t* bgr) const;
+
+    int cell_w;
+    int cell_h;
+    std::vector<uint8_t> masks;   // per glyph: cell_h rows of cell_w * 3 coverage bytes
+    std::vector<bool> blank;      // glyphs without ink draw as a plain background fill
+    uint8_t default_fg[3] = {229, 229, 229};
+    uint8_t default_bg[3] = {0, 0, 0};
+};
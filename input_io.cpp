@@ -0,0 +1,214 @@
+#include "input_io.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct StageCounters {
+    std::atomic<size_t> bytes{0};
+    std::atomic<size_t> reads{0};
+    std::atomic<int64_t> wait_us{0};
+};
+
+StageCounters counters[IoStats::STAGE_COUNT];
+const char* const STAGE_NAMES[IoStats::STAGE_COUNT] = {"open", "frames", "readahead"};
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reads exactly `length` bytes at `offset` unless the file ends first
+ssize_t readFully(int fd, uint8_t* out, size_t length, size_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = pread(fd, out + done, length - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+} // namespace
+
+std::atomic<size_t> IoStats::stalls{0};
+std::atomic<size_t> IoStats::held{0};
+
+void IoStats::add(Stage stage, size_t bytes, double wait_ms) {
+    counters[stage].bytes += bytes;
+    counters[stage].reads++;
+    counters[stage].wait_us += static_cast<int64_t>(wait_ms * 1000.0);
+}
+
+IoStats::Entry IoStats::get(Stage stage) {
+    Entry entry;
+    entry.name = STAGE_NAMES[stage];
+    entry.bytes = counters[stage].bytes;
+    entry.reads = counters[stage].reads;
+    entry.wait_ms = counters[stage].wait_us / 1000.0;
+    return entry;
+}
+
+void IoStats::reset() {
+    for (auto& counter : counters) {
+        counter.bytes = 0;
+        counter.reads = 0;
+        counter.wait_us = 0;
+    }
+    stalls = 0;
+}
+
+bool InputFile::open(const std::string& path, IoStats::Stage stage) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    auto start = std::chrono::steady_clock::now();
+    if (length >= MAP_THRESHOLD) {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mapped = static_cast<uint8_t*>(address);
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            ::close(fd);
+            IoStats::hold(length);
+            IoStats::add(stage, length, msSince(start));
+            return true;
+        }
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    buffer.resize(length);
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = readFully(fd, buffer.data() + done, std::min(CHUNK_BYTES, length - done), done);
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    IoStats::add(stage, done, msSince(start));
+    IoStats::hold(length);
+    if (done < length) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void InputFile::close() {
+    IoStats::release(length);
+    if (mapped) munmap(mapped, length);
+    mapped = nullptr;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    length = 0;
+}
+
+bool Readahead::start(const std::string& path) {
+    stop();
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    file_size = static_cast<size_t>(st.st_size);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    consumer = prefetched = 0;
+    stopping = false;
+    thread = std::thread(&Readahead::run, this);
+    return true;
+}
+
+void Readahead::stop() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    IoStats::release(held);
+    held = 0;
+}
+
+void Readahead::updateHeld() {
+    size_t bytes = scratch_bytes + (prefetched > consumer ? prefetched - consumer : 0);
+    IoStats::hold(bytes);
+    IoStats::release(held);
+    held = bytes;
+}
+
+void Readahead::setProgress(double fraction) {
+    if (fd < 0) return;
+    size_t position = static_cast<size_t>(std::min(std::max(fraction, 0.0), 1.0) * file_size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (position > prefetched + CHUNK_BYTES || position + WINDOW_BYTES < consumer) {
+            // A seek, or the decoder overtook us: read ahead from here
+            if (position > prefetched) IoStats::noteStall();
+            prefetched = position;
+        }
+        consumer = position;
+        updateHeld();
+    }
+    wake.notify_all();
+}
+
+void Readahead::run() {
+    std::vector<uint8_t> scratch(CHUNK_BYTES);
+
+    // Indexes at the end of the file (an MP4 moov atom) are read at open
+    if (file_size > WINDOW_BYTES) {
+        size_t tail = file_size - std::min(TAIL_BYTES, file_size);
+        posix_fadvise(fd, static_cast<off_t>(tail), 0, POSIX_FADV_WILLNEED);
+        auto start = std::chrono::steady_clock::now();
+        ssize_t n = readFully(fd, scratch.data(), file_size - tail, tail);
+        if (n > 0) IoStats::add(IoStats::READAHEAD, static_cast<size_t>(n), msSince(start));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    scratch_bytes = scratch.size();
+    updateHeld();
+    while (!stopping) {
+        size_t limit = std::min(file_size, consumer + WINDOW_BYTES);
+        if (prefetched >= limit) {
+            wake.wait(lock);
+            continue;
+        }
+        size_t offset = prefetched;
+        size_t length = std::min(CHUNK_BYTES, limit - offset);
+        lock.unlock();
+
+        // The hint starts the kernel's own readahead; the read makes sure
+        // the pages arrive even where hints are ignored (network mounts)
+        posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+        auto start = std::chrono::steady_clock::now();
+        ssize_t n = readFully(fd, scratch.data(), length, offset);
+        if (n > 0) IoStats::add(IoStats::READAHEAD, static_cast<size_t>(n), msSince(start));
+
+        lock.lock();
+        if (n <= 0) break;
+        // Unless a seek moved the window meanwhile
+        if (prefetched == offset) prefetched = offset + static_cast<size_t>(n);
+        updateHeld();
+    }
+    scratch_bytes = 0;
+    updateHeld();
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Bytes read and time spent waiting on them, per stage of the input
+// pipeline. Safe to update from any thread.
+class IoStats {
+public:
+    enum Stage {
+        OPEN,       // headers and probing while a source opens
+        FRAMES,     // frame data the sources read themselves
+        READAHEAD,  // prefetching for decoders that do their own reads
+        STAGE_COUNT
+    };
+
+    struct Entry {
+        const char* name = "";
+        size_t bytes = 0;
+        size_t reads = 0;
+        double wait_ms = 0.0;
+    };
+
+    static void add(Stage stage, size_t bytes, double wait_ms);
+    static void noteStall() { stalls++; }
+    static Entry get(Stage stage);
+    // Times a decoder caught up with the readahead
+    static size_t readaheadStalls() { return stalls; }
+    static void reset();
+
+    // File data kept in memory for the decoders: whole files read or
+    // mapped, and readahead windows with their scratch buffers
+    static void hold(size_t bytes) { held += bytes; }
+    static void release(size_t bytes) { held -= bytes; }
+    static size_t heldBytes() { return held; }
+
+private:
+    static std::atomic<size_t> stalls;
+    static std::atomic<size_t> held;
+};
+
+// A whole file in memory for sources that parse it themselves. Large local
+// files are mapped and prefaulted in one go (the kernel reads them as a
+// sequential stream); small files, and files that can't be mapped such as
+// some network mounts, are read in large chunks.
+class InputFile {
+public:
+    InputFile() = default;
+    ~InputFile() { close(); }
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    bool open(const std::string& path, IoStats::Stage stage);
+    void close();
+
+    const uint8_t* data() const { return mapped ? mapped : buffer.data(); }
+    size_t size() const { return length; }
+
+private:
+    static constexpr size_t MAP_THRESHOLD = 256 * 1024;
+    static constexpr size_t CHUNK_BYTES = 1 << 20;
+
+    uint8_t* mapped = nullptr;
+    std::vector<uint8_t> buffer;
+    size_t length = 0;
+};
+
+// Keeps the part of a file a decoder will read next in the page cache, for
+// decoders (cv::VideoCapture backends) whose own reads are small and
+// synchronous. A thread reads a window ahead of the decoder in large
+// chunks, after posix_fadvise(SEQUENTIAL) and WILLNEED hints; the tail is
+// fetched first because many containers keep their index there. Demuxers
+// don't report byte positions, so the decoder's position is estimated
+// from its progress through the frames. Jumps (seeks) restart the window.
+class Readahead {
+public:
+    static constexpr size_t WINDOW_BYTES = 32 << 20;
+    static constexpr size_t CHUNK_BYTES = 2 << 20;
+    static constexpr size_t TAIL_BYTES = 1 << 20;
+
+    Readahead() = default;
+    ~Readahead() { stop(); }
+    Readahead(const Readahead&) = delete;
+    Readahead& operator=(const Readahead&) = delete;
+
+    // Regular files only; false (and no thread) for anything else
+    bool start(const std::string& path);
+    void stop();
+
+    // Decoder position as a fraction of the file, 0 to 1
+    void setProgress(double fraction);
+
+private:
+    void run();
+    // Accounts the window ahead of the decoder with IoStats; mutex held
+    void updateHeld();
+
+    int fd = -1;
+    size_t file_size = 0;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    size_t consumer = 0;     // estimated decoder position
+    size_t prefetched = 0;   // end of the range already read ahead
+    size_t scratch_bytes = 0;  // the thread's read buffer, while it runs
+    size_t held = 0;           // bytes accounted with IoStats
+};
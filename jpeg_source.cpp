@@ -0,0 +1,348 @@
+#include "jpeg_source.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <dirent.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <thread>
+#include <jpeglib.h>
+
+namespace {
+
+// libjpeg reports errors by calling error_exit, which must not return
+struct ErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf escape;
+    char message[JMSG_LENGTH_MAX];
+};
+
+void onError(j_common_ptr info) {
+    ErrorManager* errors = reinterpret_cast<ErrorManager*>(info->err);
+    (*info->err->format_message)(info, errors->message);
+    longjmp(errors->escape, 1);
+}
+
+void onMessage(j_common_ptr, int) {}  // warnings about slightly damaged data
+
+bool hasJpegExtension(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = name.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".jpg" || ext == ".jpeg";
+}
+
+bool isDirectory(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool isFile(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// A single %d, %Nd or %0Nd conversion and no other '%'
+bool isNumberPattern(const std::string& path) {
+    size_t percent = path.find('%');
+    if (percent == std::string::npos || path.find('%', percent + 1) != std::string::npos) return false;
+    size_t i = percent + 1;
+    while (i < path.size() && std::isdigit(static_cast<unsigned char>(path[i]))) i++;
+    return i < path.size() && path[i] == 'd';
+}
+
+std::string formatPattern(const std::string& pattern, int number) {
+    char name[4096];
+    std::snprintf(name, sizeof(name), pattern.c_str(), number);
+    return name;
+}
+
+} // namespace
+
+int jpeg::scaleDenominator(int width, int height, int target_width, int target_height) {
+    if (target_width <= 0 || target_height <= 0) return 1;
+    for (int denom = 8; denom > 1; denom /= 2) {
+        // libjpeg rounds scaled sizes up
+        if ((width + denom - 1) / denom >= target_width && (height + denom - 1) / denom >= target_height) {
+            return denom;
+        }
+    }
+    return 1;
+}
+
+bool jpeg::readSize(const uint8_t* data, size_t size, int& width, int& height) {
+    jpeg_decompress_struct info;
+    ErrorManager errors;
+    info.err = jpeg_std_error(&errors.base);
+    errors.base.error_exit = onError;
+    errors.base.emit_message = onMessage;
+    if (setjmp(errors.escape)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    jpeg_read_header(&info, TRUE);
+    width = static_cast<int>(info.image_width);
+    height = static_cast<int>(info.image_height);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+bool jpeg::decode(const uint8_t* data, size_t size, int target_width, int target_height, cv::Mat& out,
+                  std::string* error) {
+    jpeg_decompress_struct info;
+    ErrorManager errors;
+#ifndef JCS_EXTENSIONS
+    // Before setjmp, so a longjmp never leaves its scope
+    std::vector<uint8_t> scanline;
+#endif
+    info.err = jpeg_std_error(&errors.base);
+    errors.base.error_exit = onError;
+    errors.base.emit_message = onMessage;
+    if (setjmp(errors.escape)) {
+        if (error) *error = errors.message;
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    jpeg_read_header(&info, TRUE);
+
+    info.scale_num = 1;
+    info.scale_denom = static_cast<unsigned int>(
+        scaleDenominator(info.image_width, info.image_height, target_width, target_height));
+#ifdef JCS_EXTENSIONS
+    // libjpeg-turbo writes OpenCV's channel order directly
+    info.out_color_space = JCS_EXT_BGR;
+#else
+    // Plain libjpeg: RGB, or gray which it can't expand, converted per row below
+    info.out_color_space = info.jpeg_color_space == JCS_GRAYSCALE ? JCS_GRAYSCALE : JCS_RGB;
+#endif
+    // The frame is resized to a terminal grid next; exact chroma is wasted effort
+    info.dct_method = JDCT_IFAST;
+    info.do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(&info);
+
+    out.create(static_cast<int>(info.output_height), static_cast<int>(info.output_width), CV_8UC3);
+#ifdef JCS_EXTENSIONS
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW row = out.ptr<uint8_t>(static_cast<int>(info.output_scanline));
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+#else
+    scanline.resize(static_cast<size_t>(info.output_width) * info.output_components);
+    while (info.output_scanline < info.output_height) {
+        uint8_t* dst = out.ptr<uint8_t>(static_cast<int>(info.output_scanline));
+        JSAMPROW row = scanline.data();
+        jpeg_read_scanlines(&info, &row, 1);
+        for (size_t x = 0; x < info.output_width; ++x, dst += 3) {
+            const uint8_t* src = &scanline[x * info.output_components];
+            dst[0] = src[info.output_components == 1 ? 0 : 2];
+            dst[1] = src[info.output_components == 1 ? 0 : 1];
+            dst[2] = src[0];
+        }
+    }
+#endif
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+JpegSource::JpegSource()
+    : lookahead(std::min(std::max(std::thread::hardware_concurrency(), 2u), 8u)) {}
+
+JpegSource::~JpegSource() {
+    // Workers finish the frame in hand; queued ones are dropped
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobs_ready.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void JpegSource::setTargetSize(int width, int height) {
+    target_width = width;
+    target_height = height;
+}
+
+bool JpegSource::seek(double ms) {
+    if (!seekPackets(ms)) return false;
+    // Frames decoding ahead belong to the old position
+    pending.clear();
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.clear();
+    }
+    exhausted = false;
+    return true;
+}
+
+JpegSource::Decoded JpegSource::decodePacket(const Packet& packet, int target_width, int target_height) {
+    Decoded decoded;
+    decoded.timestamp = packet.timestamp;
+    InputFile file;
+    const uint8_t* data = packet.data.data();
+    size_t size = packet.data.size();
+    if (!packet.path.empty()) {
+        if (!file.open(packet.path, IoStats::FRAMES)) {
+            std::cerr << "Warning: cannot read " << packet.path << std::endl;
+            return decoded;
+        }
+        data = file.data();
+        size = file.size();
+    }
+    std::string error;
+    if (!jpeg::decode(data, size, target_width, target_height, decoded.frame, &error)) {
+        std::cerr << "Warning: skipping damaged JPEG frame: " << error << std::endl;
+        decoded.frame.release();
+    }
+    return decoded;
+}
+
+void JpegSource::work() {
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+    while (true) {
+        jobs_ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (stopping) return;
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        try {
+            job.result.set_value(decodePacket(job.packet, job.target_width, job.target_height));
+        } catch (...) {
+            job.result.set_exception(std::current_exception());
+        }
+        lock.lock();
+    }
+}
+
+bool JpegSource::read(cv::Mat& frame) {
+    if (workers.empty()) {
+        for (size_t i = 0; i < lookahead; ++i) workers.emplace_back(&JpegSource::work, this);
+    }
+    while (true) {
+        // Keep `lookahead` frames decoding, at the size wanted now
+        while (!exhausted && pending.size() < lookahead) {
+            Job job;
+            if (!nextPacket(job.packet)) {
+                exhausted = true;
+                break;
+            }
+            job.target_width = target_width;
+            job.target_height = target_height;
+            pending.push_back(job.result.get_future());
+            {
+                std::lock_guard<std::mutex> lock(jobs_mutex);
+                jobs.push_back(std::move(job));
+            }
+            jobs_ready.notify_one();
+        }
+        if (pending.empty()) return false;
+
+        Decoded decoded = pending.front().get();
+        pending.pop_front();
+        // A damaged frame is skipped rather than ending playback
+        if (decoded.frame.empty()) continue;
+        frame = decoded.frame;
+        last_timestamp = decoded.timestamp;
+        return true;
+    }
+}
+
+bool ImageSequenceSource::isSequencePath(const std::string& path) {
+    return isDirectory(path) || (isNumberPattern(path) && hasJpegExtension(path));
+}
+
+std::unique_ptr<ImageSequenceSource> ImageSequenceSource::open(const std::string& path) {
+    std::unique_ptr<ImageSequenceSource> source(new ImageSequenceSource());
+    if (isDirectory(path)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) return nullptr;
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (hasJpegExtension(name) && isFile(path + "/" + name)) source->files.push_back(path + "/" + name);
+        }
+        closedir(dir);
+        std::sort(source->files.begin(), source->files.end());
+    } else if (isNumberPattern(path)) {
+        int number = isFile(formatPattern(path, 0)) ? 0 : 1;
+        for (std::string name = formatPattern(path, number); isFile(name); name = formatPattern(path, ++number)) {
+            source->files.push_back(name);
+        }
+    }
+    if (source->files.empty()) return nullptr;
+
+    InputFile first;
+    if (!first.open(source->files.front(), IoStats::OPEN) ||
+        !jpeg::readSize(first.data(), first.size(), source->width, source->height)) {
+        std::cerr << "Error: " << source->files.front() << " is not a readable JPEG" << std::endl;
+        return nullptr;
+    }
+    return source;
+}
+
+bool ImageSequenceSource::nextPacket(Packet& packet) {
+    if (next_file >= files.size()) return false;
+    packet.path = files[next_file];
+    packet.timestamp = next_file * 1000.0 / DEFAULT_FPS;
+    next_file++;
+    return true;
+}
+
+bool ImageSequenceSource::seekPackets(double ms) {
+    double index = std::floor(std::max(ms, 0.0) * DEFAULT_FPS / 1000.0 + 0.5);
+    next_file = std::min(static_cast<size_t>(index), files.size());
+    return true;
+}
+
+std::unique_ptr<MjpegSource> MjpegSource::open(const std::string& path) {
+    std::unique_ptr<MjpegSource> source(new MjpegSource());
+    source->readahead.start(path);
+    if (!source->cap.open(path) || !source->cap.isOpened()) return nullptr;
+
+    source->rate = source->cap.get(cv::CAP_PROP_FPS);
+    source->frames = static_cast<int>(source->cap.get(cv::CAP_PROP_FRAME_COUNT));
+    source->width = static_cast<int>(source->cap.get(cv::CAP_PROP_FRAME_WIDTH));
+    source->height = static_cast<int>(source->cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+
+    // Raw packets from the demuxer; some backends can't, and some files
+    // leave out the Huffman tables libjpeg needs, so probe one frame
+    if (!source->cap.set(cv::CAP_PROP_FORMAT, -1)) return nullptr;
+    cv::Mat raw;
+    if (!source->cap.read(raw) || raw.empty()) return nullptr;
+    Packet& first = source->first;
+    first.data.assign(raw.ptr<uint8_t>(), raw.ptr<uint8_t>() + raw.total() * raw.elemSize());
+    first.timestamp = source->cap.get(cv::CAP_PROP_POS_MSEC);
+    cv::Mat probe;
+    if (!jpeg::decode(first.data.data(), first.data.size(), 1, 1, probe)) return nullptr;
+    source->first_pending = true;
+    return source;
+}
+
+bool MjpegSource::nextPacket(Packet& packet) {
+    if (first_pending) {
+        packet = std::move(first);
+        first_pending = false;
+        return true;
+    }
+    cv::Mat raw;
+    if (!cap.read(raw) || raw.empty()) return false;
+    packet.data.assign(raw.ptr<uint8_t>(), raw.ptr<uint8_t>() + raw.total() * raw.elemSize());
+    packet.timestamp = cap.get(cv::CAP_PROP_POS_MSEC);
+    if (frames > 0) readahead.setProgress(static_cast<double>(++packets_read) / frames);
+    return true;
+}
+
+bool MjpegSource::seekPackets(double ms) {
+    if (!cap.set(cv::CAP_PROP_POS_MSEC, std::max(ms, 0.0))) return false;
+    first_pending = false;
+    packets_read = static_cast<int>(ms * std::max(rate, 0.0) / 1000.0);
+    if (frames > 0) readahead.setProgress(static_cast<double>(packets_read) / frames);
+    return true;
+}
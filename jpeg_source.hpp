@@ -0,0 +1,143 @@
+#pragma once
+#include "frame_source.hpp"
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// JPEG decoding through libjpeg(-turbo), which can scale by 1/2, 1/4 or 1/8
+// while decoding: the inverse DCT simply produces fewer pixels, so most of
+// the work of a full-size decode is never done.
+namespace jpeg {
+
+// Largest denominator (1, 2, 4 or 8) whose output still covers the target;
+// 1 when there is no target
+int scaleDenominator(int width, int height, int target_width, int target_height);
+
+// Image size from the header alone; false if it is not a readable JPEG
+bool readSize(const uint8_t* data, size_t size, int& width, int& height);
+
+// Decodes to BGR at the largest reduction that still covers the target.
+// False for data libjpeg cannot decode, with its reason in `error` if given.
+bool decode(const uint8_t* data, size_t size, int target_width, int target_height, cv::Mat& out,
+            std::string* error = nullptr);
+
+} // namespace jpeg
+
+// Sources whose frames are individual JPEG images. Frames are decoded at
+// reduced scale for the size the player last asked for, several at a time
+// on a few long-lived worker threads ahead of playback; read() hands them
+// out in order.
+class JpegSource : public FrameSource {
+public:
+    ~JpegSource() override;
+
+    bool read(cv::Mat& frame) override;
+    double timestamp() const override { return last_timestamp; }
+    void setTargetSize(int width, int height) override;
+    bool seek(double ms) override;
+
+protected:
+    // One compressed frame: its bytes, or the file holding them
+    struct Packet {
+        std::vector<uint8_t> data;
+        std::string path;
+        double timestamp = -1.0;
+    };
+
+    JpegSource();
+    // Next compressed frame in order, on the reading thread; false at the end
+    virtual bool nextPacket(Packet& packet) = 0;
+    // Makes nextPacket() continue at source time `ms`; false if it can't
+    virtual bool seekPackets(double ms) { (void)ms; return false; }
+
+private:
+    struct Decoded {
+        cv::Mat frame;
+        double timestamp = -1.0;
+    };
+
+    struct Job {
+        Packet packet;
+        int target_width = 0;
+        int target_height = 0;
+        std::promise<Decoded> result;
+    };
+
+    static Decoded decodePacket(const Packet& packet, int target_width, int target_height);
+    void work();
+
+    size_t lookahead;
+    std::deque<std::future<Decoded>> pending;
+    // Started by the first read(), so they inherit the reading thread's priority
+    std::vector<std::thread> workers;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_ready;
+    std::deque<Job> jobs;
+    bool stopping = false;
+    bool exhausted = false;
+    int target_width = 0;
+    int target_height = 0;
+    double last_timestamp = -1.0;
+};
+
+// A directory of .jpg/.jpeg files played in name order, or a printf-style
+// pattern such as "frames/%05d.jpg" counting up from 0 or 1
+class ImageSequenceSource : public JpegSource {
+public:
+    static const int DEFAULT_FPS = 25;
+
+    // nullptr if the path names no JPEG files
+    static std::unique_ptr<ImageSequenceSource> open(const std::string& path);
+    static bool isSequencePath(const std::string& path);
+
+    double fps() const override { return DEFAULT_FPS; }
+    int frameCount() const override { return static_cast<int>(files.size()); }
+    int frameWidth() const override { return width; }
+    int frameHeight() const override { return height; }
+
+protected:
+    bool nextPacket(Packet& packet) override;
+    bool seekPackets(double ms) override;
+
+private:
+    std::vector<std::string> files;
+    size_t next_file = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Motion JPEG in any container cv::VideoCapture reads: the capture only
+// demuxes (raw packets), and the JPEG frames are decoded here
+class MjpegSource : public JpegSource {
+public:
+    // nullptr unless the capture hands out raw packets that libjpeg decodes
+    static std::unique_ptr<MjpegSource> open(const std::string& path);
+
+    double fps() const override { return rate; }
+    int frameCount() const override { return frames; }
+    int frameWidth() const override { return width; }
+    int frameHeight() const override { return height; }
+
+protected:
+    bool nextPacket(Packet& packet) override;
+    bool seekPackets(double ms) override;
+
+private:
+    Readahead readahead;
+    cv::VideoCapture cap;
+    Packet first;       // read while probing, handed out first
+    bool first_pending = false;
+    double rate = 0.0;
+    int frames = 0;
+    int packets_read = 0;
+    int width = 0;
+    int height = 0;
+};
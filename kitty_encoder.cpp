@@ -0,0 +1,147 @@
+#include "kitty_encoder.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// Names of the objects not unlinked yet, for cleanupAll(). A slot is
+// claimed, then its name written, then it is marked ready; only ready
+// names are read.
+enum SlotState { FREE, CLAIMED, READY };
+const int SLOTS = 64;
+const size_t NAME_BYTES = 64;
+char slot_names[SLOTS][NAME_BYTES];
+std::atomic<int> slot_states[SLOTS];
+
+int track(const std::string& name) {
+    if (name.size() >= NAME_BYTES) return -1;
+    for (int i = 0; i < SLOTS; ++i) {
+        int expected = FREE;
+        if (!slot_states[i].compare_exchange_strong(expected, CLAIMED)) continue;
+        std::memcpy(slot_names[i], name.c_str(), name.size() + 1);
+        slot_states[i] = READY;
+        return i;
+    }
+    return -1;
+}
+
+void untrack(int slot) {
+    if (slot >= 0) slot_states[slot] = FREE;
+}
+
+std::string base64(const std::string& data) {
+    static const char TABLE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t v = (uint8_t(data[i]) << 16) | (uint8_t(data[i + 1]) << 8) | uint8_t(data[i + 2]);
+        out += TABLE[v >> 18];
+        out += TABLE[(v >> 12) & 63];
+        out += TABLE[(v >> 6) & 63];
+        out += TABLE[v & 63];
+    }
+    if (i < data.size()) {
+        uint32_t v = uint8_t(data[i]) << 16;
+        if (i + 1 < data.size()) v |= uint8_t(data[i + 1]) << 8;
+        out += TABLE[v >> 18];
+        out += TABLE[(v >> 12) & 63];
+        out += (i + 1 < data.size()) ? TABLE[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+} // namespace
+
+KittyEncoder::KittyEncoder() {
+    // Distinct per process so two players never share objects or images
+    prefix = "/terminal_video-" + std::to_string(getpid()) + "-";
+    image_id = 1 + static_cast<uint32_t>(getpid()) % 0xFFFFFF;
+}
+
+KittyEncoder::~KittyEncoder() {
+    cleanup();
+}
+
+void KittyEncoder::prepare(const cv::Mat& frame, int max_width, int max_height, cv::Mat& rgb) {
+    if (frame.empty() || max_width <= 0 || max_height <= 0) {
+        rgb.release();
+        return;
+    }
+    double scale = std::min(static_cast<double>(max_width) / frame.cols, static_cast<double>(max_height) / frame.rows);
+    cv::Size size(std::max(1, static_cast<int>(frame.cols * scale)), std::max(1, static_cast<int>(frame.rows * scale)));
+    cv::Mat scaled;
+    cv::resize(frame, scaled, size, 0, 0, cv::INTER_AREA);
+    // The protocol wants RGB; swap while copying into a packed image
+    rgb.create(size.height, size.width, CV_8UC3);
+    for (int y = 0; y < size.height; ++y) {
+        const cv::Vec3b* src = scaled.ptr<cv::Vec3b>(y);
+        cv::Vec3b* dst = rgb.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < size.width; ++x) dst[x] = cv::Vec3b(src[x][2], src[x][1], src[x][0]);
+    }
+}
+
+bool KittyEncoder::present(const cv::Mat& rgb, std::string& out) {
+    if (rgb.empty()) return false;
+    size_t row_bytes = static_cast<size_t>(rgb.cols) * 3;
+    size_t bytes = row_bytes * rgb.rows;
+
+    std::string name = prefix + std::to_string(sequence);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+        map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    uint8_t* dst = static_cast<uint8_t*>(map);
+    for (int y = 0; y < rgb.rows; ++y) {
+        std::memcpy(dst + y * row_bytes, rgb.ptr(y), row_bytes);
+    }
+    munmap(map, bytes);
+
+    // Same image and placement id every frame: replaced in place; C=1
+    // leaves the cursor where it was, q=2 keeps replies off our input
+    out += "\033_Ga=T,f=24,t=s,s=" + std::to_string(rgb.cols) + ",v=" + std::to_string(rgb.rows) +
+           ",S=" + std::to_string(bytes) + ",i=" + std::to_string(image_id) + ",p=1,C=1,q=2;" + base64(name) +
+           "\033\\";
+
+    sequence++;
+    pending.push_back({name, bytes, track(name)});
+    shm_bytes += bytes;
+    while (pending.size() > KEEP_FRAMES) {
+        // Already gone if the terminal read it
+        shm_unlink(pending.front().name.c_str());
+        untrack(pending.front().slot);
+        shm_bytes -= pending.front().bytes;
+        pending.pop_front();
+    }
+    return true;
+}
+
+std::string KittyEncoder::deleteCommand() const {
+    return "\033_Ga=d,d=I,i=" + std::to_string(image_id) + ",q=2\033\\";
+}
+
+void KittyEncoder::cleanup() {
+    for (const auto& object : pending) {
+        shm_unlink(object.name.c_str());
+        untrack(object.slot);
+    }
+    pending.clear();
+    shm_bytes = 0;
+}
+
+void KittyEncoder::cleanupAll() {
+    for (int i = 0; i < SLOTS; ++i) {
+        if (slot_states[i] == READY) shm_unlink(slot_names[i]);
+    }
+}
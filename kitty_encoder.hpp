@@ -0,0 +1,57 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// Shows frames through the kitty graphics protocol without pushing pixels
+// through the pty: each frame is written to a POSIX shared memory object
+// and only a short transmission command naming it (t=s) is sent. The
+// terminal reads and unlinks the object. Every frame reuses one image and
+// placement id, so it replaces the previous one in place.
+class KittyEncoder {
+public:
+    KittyEncoder();
+    ~KittyEncoder();
+    KittyEncoder(const KittyEncoder&) = delete;
+    KittyEncoder& operator=(const KittyEncoder&) = delete;
+
+    // Scales a BGR frame to RGB pixels fitting max_width x max_height,
+    // keeping its aspect ratio. Safe to call from any thread.
+    static void prepare(const cv::Mat& frame, int max_width, int max_height, cv::Mat& rgb);
+
+    // Writes `rgb` to a new shared memory object and appends the command
+    // that shows it at the cursor. Returns false if the object cannot be
+    // created; nothing is appended then.
+    bool present(const cv::Mat& rgb, std::string& out);
+
+    // Removes the shared memory objects the terminal may not have taken
+    void cleanup();
+    // The same for every encoder, without locks or allocation, so a signal
+    // handler can call it before the process exits
+    static void cleanupAll();
+    // Command that removes the image from the screen
+    std::string deleteCommand() const;
+
+    size_t framesSent() const { return sequence; }
+    // Bytes of the objects kept for the terminal, at most; safe from any thread
+    size_t memoryUsage() const { return shm_bytes; }
+
+private:
+    // Objects of this many recent frames are left for the terminal to read;
+    // older ones are unlinked in case it never did (no kitty support)
+    static const size_t KEEP_FRAMES = 8;
+
+    std::string prefix;
+    uint32_t image_id;
+    uint64_t sequence = 0;
+    struct Pending {
+        std::string name;
+        size_t bytes;
+        int slot;   // in the table cleanupAll() reads, or -1 if it was full
+    };
+    std::deque<Pending> pending;
+    std::atomic<size_t> shm_bytes{0};
+};
@@ -12,27 +12,60 @@
 #include <sys/ioctl.h>
 #include <signal.h>
 #include <poll.h>
-#include <unordered_map>
 #include <sstream>
 #include <atomic>
 #include <condition_variable>
+#include <mutex>
+#include <future>
+#include <memory>
 #include "player_config.hpp"
+#include "ascii_renderer.hpp"
+#include "frame_source.hpp"
+#include "crop_detector.hpp"
+#include "viewport.hpp"
+#include "refine_renderer.hpp"
+#include "session.hpp"
+#include "memory_governor.hpp"
+#include "buffer_depth.hpp"
+#include "delta_encoder.hpp"
+#include "video_wall.hpp"
+#include "sixel_encoder.hpp"
+#include "kitty_encoder.hpp"
+#include "video_exporter.hpp"
+#include "frame_timing.hpp"
+#include "animation_cache.hpp"
+#include "thumbnail_index.hpp"
+#include "cell_stream.hpp"
+#include "stream_output.hpp"
 
 class ASCIIVideoPlayer {
 public:
     // Add these member variables near the beginning of the class
     bool block_mode = false;
-    int current_width = 0;
-    int current_height = 0;
+    // Grid size; set by the display thread (resize, fullscreen), read by the buffer thread
+    std::atomic<int> current_width{0};
+    std::atomic<int> current_height{0};
     int original_width = 0;
     int original_height = 0;
 
 private:
     // Move private members here
-    static const size_t FRAME_BUFFER_SIZE = 16;
+    static const size_t MIN_BUFFER_DEPTH = 2;  // floor for the memory governor
+    static constexpr size_t MIN_CACHE_ENTRIES = 256;     // color cache limits under memory pressure
+    static constexpr size_t MAX_CACHE_LIMIT = 1 << 16;   // above this, no limit
     struct BufferedFrame {
         cv::Mat frame;
         std::string ascii_output;
+        int source_index = 0;     // playlist item the frame was decoded from
+        int source_frames = 0;    // frame count of that item
+        bool starts_item = false; // first frame after a transition or loop restart
+        bool after_seek = false;  // first frame decoded after a seek
+        cv::Rect crop;            // autocrop region (whole frame when off)
+        CellGrid cells;           // rendered cells in delta, wall, export and stream mode (ascii_output stays empty)
+        cv::Mat pixels;           // RGB image for the kitty backend
+        int field = -1;           // interlaced rows drawn over the previous frame, -1 for all
+        int rows = 0;             // grid rows
+        double media_ms = 0.0;    // presentation time within its item, from the frame timestamps
     };
     std::vector<BufferedFrame> frame_buffer;
     std::thread buffer_thread;
@@ -40,56 +73,120 @@ private:
     std::mutex buffer_mutex;
     std::condition_variable buffer_cv;
     bool loop_video = false;
+    
+    // Decode-ahead depth: adapted to jitter and underruns, capped by memory pressure
+    BufferDepthController depth_controller;
+    std::atomic<double> frame_interval_ms{33.33};
+    // Typical interval between source frames, measured from their timestamps
+    std::atomic<double> source_interval_ms{33.33};
+    
+    // Byte budget for buffers and caches; lowers memory_depth_cap under pressure
+    MemoryGovernor memory;
+    std::atomic<size_t> memory_depth_cap{16};
+    std::atomic<size_t> last_frame_bytes{0};
 
-public:
-    // Enhanced ASCII character set for better detail
-    const std::string ASCII_CHARS = " .'`^\",:;Il!i><~+_-?][}{1)(|\\/tfjrxnuvczXYUJCLQ0OZmwqpdbkhao*#MW&8%B@$";
-    
-    // ANSI color codes for 8-bit color mode
-    enum ColorMode {
-        MONO,        // Black and white
-        COLOR_8BIT,  // 256-color mode
-        COLOR_24BIT  // True color (RGB)
+    // Send only what changed on screen, optionally within a byte budget per frame
+    bool delta_mode = false;
+    DeltaEncoder delta_encoder;
+    size_t delta_bytes_total = 0;
+    size_t delta_frames = 0;
+    size_t delta_deferred_frames = 0;
+
+    // Half the rows per frame, alternating; a full frame whenever the grid or
+    // the look changes, or the screen was disturbed
+    bool interlace = false;
+    std::atomic<bool> interlace_full_requested{true};
+    // The next buffered field has nothing under it to draw over; the buffer
+    // thread redraws that frame whole (set and cleared under buffer_mutex)
+    bool refield_requested = false;
+
+    // Several terminals showing one picture; frames are rendered as cells once
+    bool wall_mode = false;
+
+    // Frames drawn into a video file; also rendered as cells
+    bool export_mode = false;
+
+    // Cells sent to remote viewers as a binary stream
+    bool stream_mode = false;
+
+    // Sixel images in place of the text frame, same buffering and pacing
+    bool sixel_mode = false;
+    SixelEncoder sixel_encoder;
+
+    // Kitty images passed through shared memory; the display thread writes them
+    bool kitty_mode = false;
+    KittyEncoder kitty_encoder;
+    size_t kitty_failures = 0;
+    size_t kitty_bytes_total = 0;   // through the terminal
+    size_t kitty_shm_total = 0;     // through shared memory
+
+    // Playlist and gapless transitions between items (and loop restarts)
+    struct PreparedSource {
+        std::unique_ptr<FrameSource> source;
+        cv::Mat first_frame;
+        double first_timestamp = -1.0;
+        int index = 0;
     };
+    std::vector<std::string> playlist;
+    std::atomic<size_t> prepared_bytes{0};   // first frame of the prepared next item
+    std::atomic<size_t> transition_count{0};
+    double transition_gap_total_ms = 0.0;
+    double transition_gap_max_ms = 0.0;
+
+    // Black bar removal, applied as an ROI before the resize
+    bool autocrop = false;
+    CropDetector crop_detector;
+
+    // Zoom/pan region of interest, also applied before the resize
+    Viewport viewport;
+    std::mutex viewport_mutex;
+
+    // Scrubbing shows thumbnails from a background index right away; the
+    // buffer thread seeks once the keys stop
+    static constexpr double SCRUB_SETTLE_MS = 400.0;
+    static constexpr double DEFAULT_SCRUB_STEP_MS = 10000.0;
+    ThumbnailIndex thumbnails;
+    double thumbnail_interval_ms = 10000.0;   // 0 turns the index off
+    int thumbnail_item = -1;
+    std::atomic<double> seek_request_ms{-1.0};
+    std::atomic<int> seek_request_item{0};
+    size_t seek_count = 0;
+    double seek_time_total_ms = 0.0;
+
+    // Startup and throughput measurements
+    bool prompt_before_play = true;
+    std::atomic<bool> first_paint_done{false};
+    double convert_time_total_ms = 0.0;
+    size_t frames_converted = 0;
+
+    // Progressive refinement of the frame on screen while paused
+    cv::Mat last_frame;
+    cv::Rect last_crop;
+    std::thread refine_thread;
+    std::atomic<bool> refine_cancel{false};
+    std::atomic<bool> refine_ready{false};
+    std::mutex refine_mutex;
+    std::string refined_output;
+    std::atomic<size_t> refine_scratch_bytes{0};   // while a refinement runs
+
+    // Clock, keys and terminal size for playback; recordable and replayable
+    std::unique_ptr<Session> session;
+
+public:
+    // Color modes are the renderer's
+    using ColorMode = RenderParams::ColorMode;
+    static constexpr ColorMode MONO = RenderParams::MONO;
+    static constexpr ColorMode COLOR_8BIT = RenderParams::COLOR_8BIT;
+    static constexpr ColorMode COLOR_24BIT = RenderParams::COLOR_24BIT;
+    using CacheStats = AsciiRenderer::CacheStats;
     
     ColorMode current_color_mode = MONO;
     struct termios original_termios;
     bool terminal_modified = false;
     
-    // Color caching structures
-    struct ColorKey {
-        uint8_t r, g, b;
-        bool background;
-        
-        bool operator==(const ColorKey& other) const {
-            return r == other.r && g == other.g && b == other.b && background == other.background;
-        }
-    };
-    
-    struct ColorKeyHasher {
-        std::size_t operator()(const ColorKey& k) const {
-            return ((std::size_t)k.r << 24) | ((std::size_t)k.g << 16) | ((std::size_t)k.b << 8) | (k.background ? 1 : 0);
-        }
-    };
-    
-    // Color caches for different modes
-    std::unordered_map<ColorKey, std::string, ColorKeyHasher> color_cache_8bit;
-    std::unordered_map<ColorKey, std::string, ColorKeyHasher> color_cache_24bit;
-    std::unordered_map<uint32_t, int> rgb_to_8bit_cache; // RGB packed as uint32_t -> 8-bit color
-    
-    // Cache statistics
-    struct CacheStats {
-        size_t hits = 0;
-        size_t misses = 0;
-        size_t cache_size = 0;
-        
-        double hit_rate() const {
-            return (hits + misses > 0) ? (double)hits / (hits + misses) * 100.0 : 0.0;
-        }
-    } cache_stats;
-    
-    // Performance: Pre-computed brightness lookup table
-    std::vector<int> brightness_to_char_idx;
+    // Used by one thread at a time: the buffer thread, or the camera loop
+    AsciiRenderer renderer;
+    std::atomic<bool> cache_reset_requested{false};
     
     struct TerminalSize {
         int width;
@@ -126,6 +223,7 @@ public:
     };
     
     TerminalSize getTerminalSize() {
+        if (session) return {session->terminalWidth(), session->terminalHeight()};
         struct winsize w;
         ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
         return {w.ws_col, w.ws_row};
@@ -136,323 +234,336 @@ public:
         return poll(&pfd, 1, 0) > 0;
     }
     
-    // Signal handler for clean exit
-    static ASCIIVideoPlayer* instance;
-    static void signalHandler(int signal) {
-        std::cout << "\033[?25h\033[?1049l\033[0m\n";
-        std::exit(signal);
-    }
-    
-    // Pack RGB into uint32_t for caching
-    uint32_t packRGB(int r, int g, int b) {
-        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
-    }
-    
-    // Cached RGB to 8-bit color conversion
-    int rgbTo8BitColorCached(int r, int g, int b) {
-        uint32_t rgb_key = packRGB(r, g, b);
-        
-        auto it = rgb_to_8bit_cache.find(rgb_key);
-        if (it != rgb_to_8bit_cache.end()) {
-            cache_stats.hits++;
-            return it->second;
-        }
-        
-        cache_stats.misses++;
-        
-        int color;
-        if (r == g && g == b) {
-            // Grayscale
-            if (r < 8) color = 16;
-            else if (r > 248) color = 231;
-            else color = static_cast<int>(((r - 8) / 247.0) * 24) + 232;
-        } else {
-            // Color cube
-            int ir = static_cast<int>((r / 255.0) * 5);
-            int ig = static_cast<int>((g / 255.0) * 5);
-            int ib = static_cast<int>((b / 255.0) * 5);
-            color = 16 + (36 * ir) + (6 * ig) + ib;
+    // Pixel size of one cell; terminals that do not report it are assumed to use 10x20
+    cv::Size cellPixels() {
+        struct winsize w;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && w.ws_xpixel > 0 && w.ws_ypixel > 0 &&
+            w.ws_col > 0 && w.ws_row > 0) {
+            return cv::Size(std::max(w.ws_xpixel / w.ws_col, 1), std::max(w.ws_ypixel / w.ws_row, 1));
         }
-        
-        rgb_to_8bit_cache[rgb_key] = color;
-        cache_stats.cache_size = rgb_to_8bit_cache.size() + color_cache_8bit.size() + color_cache_24bit.size();
-        return color;
+        return cv::Size(10, 20);
     }
     
-    // Cached color code generation
-    std::string getColorCodeCached(int r, int g, int b, bool background = false) {
-        if (current_color_mode == MONO) return "";
-        
-        ColorKey key = {(uint8_t)r, (uint8_t)g, (uint8_t)b, background};
-        
-        if (current_color_mode == COLOR_8BIT) {
-            auto it = color_cache_8bit.find(key);
-            if (it != color_cache_8bit.end()) {
-                cache_stats.hits++;
-                return it->second;
-            }
-            
-            cache_stats.misses++;
-            int color = rgbTo8BitColorCached(r, g, b);
-            std::string code = "\033[" + std::to_string(background ? 48 : 38) + ";5;" + std::to_string(color) + "m";
-            color_cache_8bit[key] = code;
-            cache_stats.cache_size = rgb_to_8bit_cache.size() + color_cache_8bit.size() + color_cache_24bit.size();
-            return code;
-        } else if (current_color_mode == COLOR_24BIT) {
-            auto it = color_cache_24bit.find(key);
-            if (it != color_cache_24bit.end()) {
-                cache_stats.hits++;
-                return it->second;
-            }
-            
-            cache_stats.misses++;
-            std::string code = "\033[" + std::to_string(background ? 48 : 38) + ";2;" + 
-                              std::to_string(r) + ";" + std::to_string(g) + ";" + std::to_string(b) + "m";
-            color_cache_24bit[key] = code;
-            cache_stats.cache_size = rgb_to_8bit_cache.size() + color_cache_8bit.size() + color_cache_24bit.size();
-            return code;
+    // Pixels available for an image covering the given cell area
+    cv::Size pixelArea(int cols, int rows) {
+        cv::Size cell = cellPixels();
+        if (cols == 0 || rows == 0) {
+            TerminalSize term = getTerminalSize();
+            cols = term.width - 2;
+            rows = term.height - 3;
         }
-        
-        return "";
+        return cv::Size(std::max(cols, 1) * cell.width, std::max(rows, 1) * cell.height);
     }
     
+    bool graphicsMode() const { return sixel_mode || kitty_mode; }
+    
     std::string resetColor() {
         return (current_color_mode != MONO) ? "\033[0m" : "";
     }
-    
-    // Initialize brightness lookup table for performance
-    void initializeBrightnessLookup() {
-        brightness_to_char_idx.resize(256);
-        for (int i = 0; i < 256; ++i) {
-            brightness_to_char_idx[i] = (i * (ASCII_CHARS.size() - 1)) / 255;
-        }
-    }
 
     ASCIIVideoPlayer() {
-        instance = this;
-        initializeBrightnessLookup();
         current_width = 0;
         current_height = 0;
         original_width = 0;
         original_height = 0;
         block_mode = false;
-        
-        // Set up signal handlers for clean exit
-        signal(SIGINT, signalHandler);
-        signal(SIGTERM, signalHandler);
-        signal(SIGQUIT, signalHandler);
     }
     
     void setColorMode(ColorMode mode) {
-        if (current_color_mode != mode) {
-            current_color_mode = mode;
-            // Clear caches when switching modes to save memory
-            if (mode != COLOR_8BIT) {
-                color_cache_8bit.clear();
-                rgb_to_8bit_cache.clear();
-            }
-            if (mode != COLOR_24BIT) {
-                color_cache_24bit.clear();
-            }
-            cache_stats.cache_size = rgb_to_8bit_cache.size() + color_cache_8bit.size() + color_cache_24bit.size();
-        }
+        // The renderer drops the other mode's caches on its next frame
+        current_color_mode = mode;
     }
     
     ColorMode getColorMode() const {
         return current_color_mode;
     }
     
-    // Clear all caches (useful for memory management)
+    // Clear all caches (useful for memory management); done by the rendering thread
     void clearColorCaches() {
-        color_cache_8bit.clear();
-        color_cache_24bit.clear();
-        rgb_to_8bit_cache.clear();
-        cache_stats = CacheStats(); // Reset stats
+        cache_reset_requested = true;
     }
     
     // Get cache statistics
     CacheStats getCacheStats() const {
-        return cache_stats;
+        return renderer.cacheStats();
     }
     
-    std::string frameToAscii(const cv::Mat& frame, int target_width = 0, int target_height = 0) {
-        if (frame.empty()) return "";
-        
-        // Auto-detect terminal size if not specified
+    // Renderer parameters, auto-detecting the terminal size if not specified
+    RenderParams renderParams(int target_width, int target_height, bool blocks) {
         if (target_width == 0 || target_height == 0) {
             TerminalSize term = getTerminalSize();
-            target_width = std::min(term.width - 2, 120);
-            target_height = std::min(term.height - 3, 40);
-        }
-        
-        // Calculate proper aspect ratio (characters are taller than wide)
-        float char_aspect_ratio = 2.2f; // Typical character height/width ratio
-        float frame_aspect = static_cast<float>(frame.cols) / frame.rows;
-        
-        int new_width, new_height;
-        if (frame_aspect > (target_width * char_aspect_ratio) / target_height) {
-            new_width = target_width;
-            new_height = static_cast<int>(target_width / frame_aspect / char_aspect_ratio);
-        } else {
-            new_height = target_height;
-            new_width = static_cast<int>(target_height * frame_aspect * char_aspect_ratio);
-        }
-        
-        // Resize frame
-        cv::Mat resized;
-        cv::resize(frame, resized, cv::Size(new_width, new_height), 0, 0, cv::INTER_AREA);
-        
-        // Convert to ASCII with cached colors
-        std::string ascii_frame;
-        ascii_frame.reserve(new_width * new_height * 20 + new_height); // Extra space for color codes
-        
-        if (current_color_mode == MONO) {
-            // Monochrome mode - convert to grayscale
-            cv::Mat gray;
-            cv::cvtColor(resized, gray, cv::COLOR_BGR2GRAY);
-            cv::equalizeHist(gray, gray); // Enhance contrast
-            
-            for (int y = 0; y < gray.rows; ++y) {
-                const uint8_t* row = gray.ptr<uint8_t>(y);
-                for (int x = 0; x < gray.cols; ++x) {
-                    ascii_frame += ASCII_CHARS[brightness_to_char_idx[row[x]]];
-                }
-                ascii_frame += '\n';
-            }
-        } else {
-            // Color mode with caching
-            std::string lastColorCode;
-            cv::Vec3b lastPixel = {255, 255, 255}; // Invalid initial color
-            
-            for (int y = 0; y < resized.rows; ++y) {
-                const cv::Vec3b* row = resized.ptr<cv::Vec3b>(y);
-                for (int x = 0; x < resized.cols; ++x) {
-                    cv::Vec3b pixel = row[x];
-                    
-                    // Only generate color code if pixel color changed
-                    if (pixel != lastPixel) {
-                        std::string colorCode = getColorCodeCached(pixel[2], pixel[1], pixel[0], false); // BGR to RGB
-                        if (colorCode != lastColorCode) {
-                            ascii_frame += colorCode;
-                            lastColorCode = colorCode;
-                        }
-                        lastPixel = pixel;
-                    }
-                    
-                    // Use pre-computed brightness lookup
-                    int brightness = static_cast<int>(0.299 * pixel[2] + 0.587 * pixel[1] + 0.114 * pixel[0]);
-                    ascii_frame += ASCII_CHARS[brightness_to_char_idx[brightness]];
-                }
-                ascii_frame += resetColor() + '\n';
-                lastColorCode.clear(); // Reset color at end of line
-            }
+            target_width = std::min(term.width - 2, AsciiRenderer::DEFAULT_WIDTH);
+            target_height = std::min(term.height - 3, AsciiRenderer::DEFAULT_HEIGHT);
         }
-        
-        return ascii_frame;
+        RenderParams params;
+        params.width = target_width;
+        params.height = target_height;
+        params.color_mode = current_color_mode;
+        params.block_mode = blocks;
+        return params;
+    }
+    
+    // Cell grid a frame is rendered into
+    cv::Size computeGridSize(const cv::Mat& frame, int target_width, int target_height) {
+        RenderParams params = renderParams(target_width, target_height, false);
+        return AsciiRenderer::gridSize(frame.cols, frame.rows, params.width, params.height);
+    }
+    
+    void frameToCells(const cv::Mat& frame, CellGrid& cells, int target_width = 0, int target_height = 0) {
+        if (cache_reset_requested.exchange(false)) renderer.clearCaches();
+        renderer.renderCells(frame, renderParams(target_width, target_height, block_mode), cells);
+    }
+    
+    std::string frameToAscii(const cv::Mat& frame, int target_width = 0, int target_height = 0, int field = -1) {
+        if (cache_reset_requested.exchange(false)) renderer.clearCaches();
+        RenderParams params = renderParams(target_width, target_height, false);
+        params.field = field;
+        return renderer.render(frame, params);
     }
     
     // Alternative color method using background colors (block style) with caching
-    std::string frameToColorBlocks(const cv::Mat& frame, int target_width = 0, int target_height = 0) {
-        if (frame.empty() || current_color_mode == MONO) return frameToAscii(frame, target_width, target_height);
-        
-        // Auto-detect terminal size if not specified
-        if (target_width == 0 || target_height == 0) {
-            TerminalSize term = getTerminalSize();
-            target_width = std::min(term.width - 2, 120);
-            target_height = std::min(term.height - 3, 40);
-        }
-        
-        // Calculate proper aspect ratio
-        float char_aspect_ratio = 2.2f;
-        float frame_aspect = static_cast<float>(frame.cols) / frame.rows;
-        
-        int new_width, new_height;
-        if (frame_aspect > (target_width * char_aspect_ratio) / target_height) {
-            new_width = target_width;
-            new_height = static_cast<int>(target_width / frame_aspect / char_aspect_ratio);
-        } else {
-            new_height = target_height;
-            new_width = static_cast<int>(target_height * frame_aspect * char_aspect_ratio);
-        }
-        
-        // Resize frame
-        cv::Mat resized;
-        cv::resize(frame, resized, cv::Size(new_width, new_height), 0, 0, cv::INTER_AREA);
-        
-        std::string ascii_frame;
-        ascii_frame.reserve(new_width * new_height * 20 + new_height);
-        
-        std::string lastColorCode;
-        cv::Vec3b lastPixel = {255, 255, 255}; // Invalid initial color
-        
-        for (int y = 0; y < resized.rows; ++y) {
-            const cv::Vec3b* row = resized.ptr<cv::Vec3b>(y);
-            for (int x = 0; x < resized.cols; ++x) {
-                cv::Vec3b pixel = row[x];
-                
-                // Only generate color code if pixel color changed
-                if (pixel != lastPixel) {
-                    std::string colorCode = getColorCodeCached(pixel[2], pixel[1], pixel[0], true); // BGR to RGB, background
-                    if (colorCode != lastColorCode) {
-                        ascii_frame += colorCode;
-                        lastColorCode = colorCode;
-                    }
-                    lastPixel = pixel;
-                }
-                
-                ascii_frame += ' ';
-            }
-            ascii_frame += resetColor() + '\n';
-            lastColorCode.clear(); // Reset color at end of line
-        }
-        
-        return ascii_frame;
+    std::string frameToColorBlocks(const cv::Mat& frame, int target_width = 0, int target_height = 0, int field = -1) {
+        if (cache_reset_requested.exchange(false)) renderer.clearCaches();
+        RenderParams params = renderParams(target_width, target_height, true);
+        params.field = field;
+        return renderer.render(frame, params);
     }
     
-    void displayVideoInfo(const cv::VideoCapture& cap) {
-        double fps = cap.get(cv::CAP_PROP_FPS);
-        int frame_count = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
-        double duration = frame_count / fps;
-        int width = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
-        int height = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+    // Text frame in the current look
+    std::string frameToText(const cv::Mat& frame, int target_width, int target_height, int field) {
+        return block_mode && current_color_mode != MONO ?
+               frameToColorBlocks(frame, target_width, target_height, field) :
+               frameToAscii(frame, target_width, target_height, field);
+    }
+    
+    void displayVideoInfo(const FrameSource& source) {
+        double fps = source.fps();
+        int frame_count = source.frameCount();
+        double duration = frame_count * nominalFrameInterval(fps) / 1000.0;
+        int width = source.frameWidth();
+        int height = source.frameHeight();
         
         std::cout << "Terminal Video Player\n";
         std::cout << "============================================\n";
         std::cout << "Video Info:\n";
         std::cout << "Resolution: " << width << "x" << height << "\n";
-        std::cout << "FPS: " << fps << "\n";
+        if (plausibleFrameRate(fps)) {
+            std::cout << "FPS: " << fps << "\n";
+        } else {
+            std::cout << "FPS: variable (container reports " << fps << "; timing from frame timestamps)\n";
+        }
         std::cout << "Duration: " << static_cast<int>(duration/60) << ":" 
                   << std::setfill('0') << std::setw(2) << static_cast<int>(duration) % 60 << "\n";
         std::cout << "Frame Count: " << frame_count << "\n";
+        if (playlist.size() > 1) {
+            std::cout << "Playlist: " << playlist.size() << " items\n";
+        }
         std::cout << "Color Mode: " << (current_color_mode == MONO ? "Monochrome" : 
-                                       current_color_mode == COLOR_8BIT ? "8-bit Color (Cached)" : "24-bit Color (Cached)") << "\n",
+                                       current_color_mode == COLOR_8BIT ? "8-bit Color (Cached)" : "24-bit Color (Cached)") << "\n";
+    }
+    
+    // Decoding is already filling the buffer while this blocks
+    void waitForStart() {
         std::cout << "Press any key to start...\n";
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         std::cin.get();
     }
     
+    // Index of the playlist item after `index`, or -1 when playback should end
+    int nextPlaylistIndex(size_t index) const {
+        if (index + 1 < playlist.size()) return static_cast<int>(index + 1);
+        return loop_video ? 0 : -1;
+    }
+    
+    // Open an item and decode its first frame so a transition costs no decode time
+    PreparedSource prepareSource(const std::string& path, int index) {
+        PreparedSource prepared;
+        prepared.index = index;
+        std::unique_ptr<FrameSource> source = FrameSource::open(path);
+        if (source && source->read(prepared.first_frame)) {
+            prepared.first_timestamp = source->timestamp();
+            prepared.source = std::move(source);
+        }
+        prepared_bytes = prepared.first_frame.total() * prepared.first_frame.elemSize();
+        return prepared;
+    }
+    
     // Add new method for frame buffering
-    void bufferFrames(cv::VideoCapture& cap) {
+    void bufferFrames(std::unique_ptr<FrameSource> source, int index) {
+        std::future<PreparedSource> next;
+        int next_index = -1;
+        int failed_items = 0;
+        int source_frames = source->frameCount();
+        cv::Mat pending_first;
+        double pending_timestamp = -1.0;
+        bool pending_starts_item = false;
+        bool seeked = false;
+        FrameTimestamps timestamps(nominalFrameInterval(source->fps()));
+        int last_field = -1;
+        cv::Size last_grid;
+        ColorMode last_mode = current_color_mode;
+        bool last_blocks = block_mode;
+        // When the current item ran out, while the transition is under way
+        std::chrono::steady_clock::time_point item_ended;
+        bool transitioning = false;
+        
         while (buffer_running) {
+            // Keep the following item (or a second capture for the loop) open and prebuffered
+            // (deferred until first paint so it doesn't compete with the first frames)
+            int wanted = nextPlaylistIndex(index);
+            if (first_paint_done && (wanted != next_index || (wanted >= 0 && !next.valid()))) {
+                next_index = wanted;
+                // Drop the old one first so its frame leaves the accounting
+                next = std::future<PreparedSource>();
+                prepared_bytes = 0;
+                next = wanted >= 0 ?
+                       std::async(std::launch::async, &ASCIIVideoPlayer::prepareSource, this, playlist[wanted], wanted) :
+                       std::future<PreparedSource>();
+            }
+            
+            double seek_to = seek_request_ms.exchange(-1.0);
+            if (seek_to >= 0.0) {
+                // Frames already decoded are from before the jump
+                seekSource(source, index, seek_request_item, seek_to, timestamps, pending_first, pending_timestamp);
+                pending_starts_item = false;
+                source_frames = source->frameCount();
+                seeked = true;
+                interlace_full_requested = true;
+                std::lock_guard<std::mutex> lock(buffer_mutex);
+                frame_buffer.clear();
+                continue;
+            }
+            
             std::unique_lock<std::mutex> lock(buffer_mutex);
-            if (frame_buffer.size() < FRAME_BUFFER_SIZE) {
+            if (refield_requested) {
+                // Later fields draw over this one, so only it needs all its rows
+                refield_requested = false;
+                if (!frame_buffer.empty() && frame_buffer.front().field >= 0) {
+                    BufferedFrame& front = frame_buffer.front();
+                    cv::Mat roi = front.frame(viewRegion(front.crop));
+                    int grid_width = current_width, grid_height = current_height;
+                    front.field = -1;
+                    front.rows = computeGridSize(roi, grid_width, grid_height).height;
+                    front.ascii_output = frameToText(roi, grid_width, grid_height, -1);
+                }
+            }
+            if (frame_buffer.size() < bufferLimit()) {
+                auto produce_start = std::chrono::steady_clock::now();
                 cv::Mat frame;
-                if (!cap.read(frame)) {
-                    if (loop_video) {
-                        cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+                bool starts_item = false;
+                double timestamp = -1.0;
+                if (!pending_first.empty()) {
+                    frame = pending_first;
+                    pending_first.release();
+                    timestamp = pending_timestamp;
+                    starts_item = pending_starts_item;
+                } else if (source->read(frame)) {
+                    timestamp = source->timestamp();
+                } else {
+                    if (!first_paint_done) {
+                        // Item ended before first paint; wait for the prefetch to be allowed
+                        lock.unlock();
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
                         continue;
                     }
-                    buffer_running = false;
-                    break;
+                    if (next_index < 0 || failed_items >= static_cast<int>(playlist.size())) {
+                        buffer_running = false;
+                        break;
+                    }
+                    lock.unlock();
+                    // The gap runs from here to the next item's first frame, over skipped items too;
+                    // time spent waiting for buffer space before this read is pacing, not transition
+                    if (!transitioning) {
+                        item_ended = std::chrono::steady_clock::now();
+                        transitioning = true;
+                    }
+                    
+                    PreparedSource prepared = next.get();
+                    prepared_bytes = 0;
+                    index = prepared.index;
+                    next_index = -1;
+                    if (!prepared.source) {
+                        // Unplayable item: skip it, but give up if nothing in the list opens
+                        failed_items++;
+                        continue;
+                    }
+                    failed_items = 0;
+                    source = std::move(prepared.source);
+                    source_frames = source->frameCount();
+                    pending_first = prepared.first_frame;
+                    pending_timestamp = prepared.first_timestamp;
+                    pending_starts_item = true;
+                    timestamps.reset(nominalFrameInterval(source->fps()));
+                    
+                    double gap = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - item_ended).count();
+                    transitioning = false;
+                    transition_count++;
+                    transition_gap_total_ms += gap;
+                    transition_gap_max_ms = std::max(transition_gap_max_ms, gap);
+                    continue;
                 }
-                
                 BufferedFrame bf;
                 bf.frame = frame;
-                bf.ascii_output = block_mode && current_color_mode != MONO ?
-                                frameToColorBlocks(frame, current_width, current_height) :
-                                frameToAscii(frame, current_width, current_height);
+                bf.source_index = index;
+                bf.source_frames = source_frames;
+                bf.starts_item = starts_item;
+                bf.after_seek = seeked;
+                seeked = false;
+                bf.media_ms = timestamps.next(timestamp);
+                source_interval_ms = timestamps.interval();
+                bf.crop = autocrop ? crop_detector.update(frame) : cv::Rect(0, 0, frame.cols, frame.rows);
+                
+                // Only the visible region is resized and converted
+                cv::Mat roi = frame(viewRegion(bf.crop));
+                auto convert_start = std::chrono::steady_clock::now();
+                // One size for the whole frame, even if a resize lands halfway
+                int grid_width = current_width, grid_height = current_height;
+                cv::Size grid = computeGridSize(roi, grid_width, grid_height);
+                bf.rows = grid.height;
+                bool render_cells = delta_mode || wall_mode || export_mode || stream_mode;
+                if (interlace && !render_cells && !graphicsMode()) {
+                    bool blocks = block_mode && current_color_mode != MONO;
+                    bool full = interlace_full_requested.exchange(false) || grid != last_grid ||
+                                current_color_mode != last_mode || blocks != last_blocks;
+                    bf.field = full ? -1 : (last_field == 0 ? 1 : 0);
+                    last_field = bf.field;
+                    last_grid = grid;
+                    last_mode = current_color_mode;
+                    last_blocks = blocks;
+                }
+                if (render_cells) {
+                    frameToCells(roi, bf.cells, grid_width, grid_height);
+                } else if (sixel_mode) {
+                    SixelParams params;
+                    cv::Size area = pixelArea(grid_width, grid_height);
+                    params.width = area.width;
+                    params.height = area.height;
+                    params.grayscale = current_color_mode == MONO;
+                    sixel_encoder.encode(roi, params, bf.ascii_output);
+                } else if (kitty_mode) {
+                    // Only scaling here; the shared memory object is made when the frame is shown
+                    cv::Size area = pixelArea(grid_width, grid_height);
+                    KittyEncoder::prepare(roi, area.width, area.height, bf.pixels);
+                    int cell_height = cellPixels().height;
+                    bf.rows = (bf.pixels.rows + cell_height - 1) / cell_height;
+                } else {
+                    bf.ascii_output = frameToText(roi, grid_width, grid_height, bf.field);
+                }
+                convert_time_total_ms += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - convert_start).count();
+                frames_converted++;
+                
+                // Sources that decode at reduced size need the resize target over the whole frame
+                cv::Size target = graphicsMode() ? pixelArea(grid_width, grid_height) :
+                                                   cv::Size(grid.width, grid.height * 2);
+                source->setTargetSize(target.width * frame.cols / std::max(roi.cols, 1),
+                                      target.height * frame.rows / std::max(roi.rows, 1));
                 
                 frame_buffer.push_back(std::move(bf));
+                depth_controller.addSample(std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - produce_start).count(), frame_interval_ms);
+                if (memory.enabled()) memory.enforce();
                 buffer_cv.notify_one();
             } else {
                 lock.unlock();
@@ -461,6 +572,616 @@ public:
         }
     }
 
+    // Moves decoding to `media_ms` into playlist item `item`: a seek where the
+    // source supports one, otherwise the item is opened again and decoded
+    // (not rendered) up to that point, leaving the frame found in `pending`.
+    // False, with decoding carrying on where it was, if the item won't open.
+    bool seekSource(std::unique_ptr<FrameSource>& source, int& index, int item, double media_ms,
+                    FrameTimestamps& timestamps, cv::Mat& pending, double& pending_timestamp) {
+        pending.release();
+        if (item == index && timestamps.hasOrigin() && source->seek(timestamps.origin() + media_ms)) {
+            timestamps.seek(media_ms);
+            return true;
+        }
+        std::unique_ptr<FrameSource> reopened = FrameSource::open(playlist[item]);
+        cv::Mat frame;
+        if (!reopened || !reopened->read(frame)) return false;
+        FrameTimestamps fresh(nominalFrameInterval(reopened->fps()));
+        double timestamp = reopened->timestamp();
+        double position = fresh.next(timestamp);
+        if (media_ms > 0.0 && reopened->seek(fresh.origin() + media_ms)) {
+            fresh.seek(media_ms);
+        } else {
+            while (buffer_running && position + fresh.interval() / 2 < media_ms && reopened->read(frame)) {
+                timestamp = reopened->timestamp();
+                position = fresh.next(timestamp);
+            }
+            fresh.seek(position);
+            pending = frame;
+            pending_timestamp = timestamp;
+        }
+        source = std::move(reopened);
+        index = item;
+        timestamps = fresh;
+        return true;
+    }
+
+    size_t bufferLimit() const {
+        return std::min(depth_controller.depth(), memory_depth_cap.load());
+    }
+    
+    cv::Rect viewRegion(const cv::Rect& crop) {
+        std::lock_guard<std::mutex> lock(viewport_mutex);
+        return viewport.apply(crop);
+    }
+    
+    // Keyboard zoom/pan; returns true if the key changed the view
+    bool handleViewKey(char key) {
+        std::lock_guard<std::mutex> lock(viewport_mutex);
+        switch (key) {
+            case 'z': case 'Z': viewport.zoomIn(); return true;
+            case 'x': case 'X': viewport.zoomOut(); return true;
+            case 'w': case 'W': viewport.pan(0, -1); return true;
+            case 's': case 'S': viewport.pan(0, 1); return true;
+            case 'a': case 'A': viewport.pan(-1, 0); return true;
+            case 'd': case 'D': viewport.pan(1, 0); return true;
+            case '0': viewport.reset(); return true;
+        }
+        return false;
+    }
+
+    // Re-render the paused frame with the slow, high-quality renderer in the background
+    void startRefinement() {
+        stopRefinement();
+        // The refined frame is text; a paused image is already full detail
+        if (last_frame.empty() || graphicsMode()) return;
+        
+        // Re-apply the view so zooming and panning work while paused
+        cv::Mat roi = last_frame(viewRegion(last_crop));
+        RefineParams params;
+        cv::Size grid = computeGridSize(roi, current_width, current_height);
+        params.grid_width = grid.width;
+        params.grid_height = grid.height;
+        params.color_mode = current_color_mode;
+        params.block_mode = block_mode;
+        params.charset = AsciiRenderer::ASCII_CHARS;
+        
+        refine_cancel = false;
+        refine_scratch_bytes = refineScratchBytes(roi.cols, roi.rows, params);
+        refine_thread = std::thread([this, frame = roi, params]() {
+            std::string output = refineFrame(frame, params, refine_cancel);
+            refine_scratch_bytes = 0;
+            if (refine_cancel || output.empty()) return;
+            std::lock_guard<std::mutex> lock(refine_mutex);
+            refined_output = std::move(output);
+            refine_ready = true;
+        });
+    }
+    
+    void stopRefinement() {
+        refine_cancel = true;
+        if (refine_thread.joinable()) {
+            refine_thread.join();
+        }
+        refine_ready = false;
+    }
+
+    // Consumers are measured and shrunk by the buffer thread, which owns the
+    // renderer and holds buffer_mutex when it calls enforce()
+    void setupMemoryAccounting() {
+        memory.clear();
+        memory_depth_cap = depth_controller.maxDepth();
+        renderer.setCacheLimit(0);
+        
+        MemoryGovernor::Consumer caches;
+        caches.name = "color caches";
+        caches.priority = 0;
+        caches.usage = [this]() { return renderer.memoryUsage() + sixel_encoder.memoryUsage(); };
+        // Cleared, then held to half the colors they had so they don't just refill
+        caches.shrink = [this](size_t) {
+            size_t before = renderer.memoryUsage() + sixel_encoder.memoryUsage();
+            size_t entries = renderer.cacheStats().cache_size;
+            renderer.clearCaches();
+            sixel_encoder.clearCaches();
+            renderer.setCacheLimit(std::max(entries / 2, MIN_CACHE_ENTRIES));
+            size_t after = renderer.memoryUsage() + sixel_encoder.memoryUsage();
+            return before - std::min(before, after);
+        };
+        caches.relax = [this]() {
+            size_t limit = renderer.cacheLimit();
+            if (limit > 0) renderer.setCacheLimit(limit * 2 > MAX_CACHE_LIMIT ? 0 : limit * 2);
+        };
+        memory.add(caches);
+        
+        MemoryGovernor::Consumer buffer;
+        buffer.name = "frame buffer";
+        buffer.priority = 0;
+        buffer.usage = [this]() {
+            size_t bytes = frame_buffer.capacity() * sizeof(BufferedFrame);
+            for (const auto& bf : frame_buffer) {
+                bytes += bf.frame.total() * bf.frame.elemSize() + bf.ascii_output.capacity() +
+                         cellBytes(bf.cells) + bf.pixels.total() * bf.pixels.elemSize();
+            }
+            return bytes;
+        };
+        // One frame shallower than it is now; the memory comes back as the buffer drains
+        buffer.limit = [this]() {
+            size_t depth = std::min(bufferLimit(), frame_buffer.size());
+            if (depth <= MIN_BUFFER_DEPTH) return false;
+            memory_depth_cap = depth - 1;
+            return true;
+        };
+        buffer.relax = [this]() {
+            if (memory_depth_cap < depth_controller.maxDepth()) memory_depth_cap++;
+        };
+        memory.add(buffer);
+        
+        MemoryGovernor::Consumer paused;
+        paused.name = "paused frame";
+        paused.priority = 2;
+        paused.usage = [this]() {
+            std::lock_guard<std::mutex> lock(refine_mutex);
+            return last_frame_bytes + refined_output.capacity() + refine_scratch_bytes;
+        };
+        memory.add(paused);
+        
+        MemoryGovernor::Consumer next_item;
+        next_item.name = "next item";
+        next_item.priority = 2;
+        next_item.usage = [this]() { return prepared_bytes.load(); };
+        memory.add(next_item);
+        
+        MemoryGovernor::Consumer images;
+        images.name = "kitty images";
+        images.priority = 2;
+        images.usage = [this]() { return kitty_encoder.memoryUsage(); };
+        memory.add(images);
+        
+        MemoryGovernor::Consumer input;
+        input.name = "input buffers";
+        input.priority = 2;
+        input.usage = []() { return IoStats::heldBytes(); };
+        memory.add(input);
+        
+        MemoryGovernor::Consumer animations;
+        animations.name = "animation cache";
+        animations.priority = 1;
+        animations.usage = []() { return AnimationCache::memoryUsage(); };
+        // Decoding again costs more than buffering less, so the buffer goes first
+        animations.shrink = [](size_t bytes) { return AnimationCache::evict(bytes); };
+        memory.add(animations);
+        
+        MemoryGovernor::Consumer index;
+        index.name = "thumbnail index";
+        index.priority = 2;
+        index.usage = [this]() { return thumbnails.memoryUsage(); };
+        memory.add(index);
+    }
+    
+    static size_t cellBytes(const CellGrid& cells) {
+        return static_cast<size_t>(cells.width()) * cells.height() * sizeof(Cell);
+    }
+    
+    // Input bytes and waiting per stage, for the stages that read anything
+    void printIoStats() {
+        for (int stage = 0; stage < IoStats::STAGE_COUNT; ++stage) {
+            IoStats::Entry entry = IoStats::get(static_cast<IoStats::Stage>(stage));
+            if (entry.reads == 0) continue;
+            std::cout << "I/O " << entry.name << ": " << MemoryGovernor::formatSize(entry.bytes) << " in "
+                      << entry.reads << " reads, " << std::fixed << std::setprecision(2) << entry.wait_ms
+                      << " ms waiting";
+            if (stage == IoStats::READAHEAD) std::cout << ", decoder caught up " << IoStats::readaheadStalls() << " times";
+            std::cout << "\n";
+        }
+    }
+    
+    void printMemoryStats() {
+        if (!memory.enabled()) return;
+        std::cout << "Memory: peak " << MemoryGovernor::formatSize(memory.peak())
+                  << " of " << MemoryGovernor::formatSize(memory.budget())
+                  << ", " << memory.shrinkCount() << " shrinks, buffer depth cap " << memory_depth_cap << "\n";
+        for (const auto& entry : memory.breakdown()) {
+            std::cout << "  " << entry.name << ": " << MemoryGovernor::formatSize(entry.bytes) << "\n";
+        }
+    }
+    
+    void startBuffering(std::unique_ptr<FrameSource> source) {
+        setupMemoryAccounting();
+        buffer_running = true;
+        first_paint_done = false;
+        transition_count = 0;
+        transition_gap_total_ms = 0.0;
+        transition_gap_max_ms = 0.0;
+        convert_time_total_ms = 0.0;
+        frames_converted = 0;
+        depth_controller.reset();
+        delta_encoder.reset();
+        delta_bytes_total = 0;
+        delta_frames = 0;
+        delta_deferred_frames = 0;
+        kitty_failures = kitty_bytes_total = kitty_shm_total = 0;
+        interlace_full_requested = true;
+        frame_buffer.reserve(depth_controller.maxDepth());
+        buffer_thread = std::thread(&ASCIIVideoPlayer::bufferFrames, this, std::move(source), 0);
+    }
+    
+    // Decode and convert the whole playlist as fast as possible without drawing
+    bool benchmarkVideo(const std::string& videoPath, int width = 0, int height = 0) {
+        auto start_time = std::chrono::steady_clock::now();
+        // Output may be redirected, so don't size from the terminal
+        current_width = width > 0 ? width : 120;
+        current_height = height > 0 ? height : 40;
+        loop_video = false;
+        if (playlist.empty() || playlist.front() != videoPath) {
+            playlist = {videoPath};
+        }
+        
+        std::unique_ptr<FrameSource> source = FrameSource::open(videoPath);
+        if (!source) {
+            std::cerr << "Error: Failed to open video file: " << videoPath << std::endl;
+            return false;
+        }
+        double open_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_time).count();
+        
+        startBuffering(std::move(source));
+        
+        double ttff_ms = 0.0;
+        size_t frames = 0, bytes = 0, text_bytes = 0;
+        AsciiRenderer text_renderer;  // the text equivalent of graphics frames, for comparison
+        while (true) {
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            if (frame_buffer.empty()) {
+                if (!buffer_running) break;
+                buffer_cv.wait_for(lock, std::chrono::milliseconds(100));
+                continue;
+            }
+            BufferedFrame bf = std::move(frame_buffer.front());
+            frame_buffer.erase(frame_buffer.begin());
+            lock.unlock();
+            
+            if (delta_mode) {
+                std::string encoded;
+                delta_encoder.encode(bf.cells, encoded);
+                bytes += encoded.size();
+            } else if (kitty_mode && !sixel_mode) {
+                std::string command;
+                if (kitty_encoder.present(bf.pixels, command)) bytes += command.size();
+            } else {
+                bytes += bf.ascii_output.size();
+            }
+            if (graphicsMode()) {
+                RenderParams params = renderParams(current_width, current_height, block_mode && current_color_mode != MONO);
+                text_bytes += text_renderer.render(bf.frame(viewRegion(bf.crop)), params).size();
+            }
+            
+            if (frames++ == 0) {
+                ttff_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start_time).count();
+                first_paint_done = true;
+            }
+        }
+        if (buffer_thread.joinable()) {
+            buffer_thread.join();
+        }
+        
+        double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Benchmark: " << videoPath << "\n"
+                  << "Grid: " << current_width << "x" << current_height << "\n"
+                  << "Open: " << open_ms << " ms\n"
+                  << "Time to first frame: " << ttff_ms << " ms\n"
+                  << "Frames: " << frames << " in " << total_s << " s ("
+                  << (total_s > 0 ? frames / total_s : 0.0) << " fps)\n"
+                  << "Convert: " << (frames_converted > 0 ? convert_time_total_ms / frames_converted : 0.0)
+                  << " ms/frame\n"
+                  << "Output: " << (frames > 0 ? bytes / frames : 0) << " bytes/frame\n";
+        if (graphicsMode() && frames > 0) {
+            std::cout << "Text renderer: " << text_bytes / frames << " bytes/frame for the same frames\n";
+        }
+        if (kitty_mode) kitty_encoder.cleanup();
+        printIoStats();
+        printMemoryStats();
+        return true;
+    }
+
+    // Draw every frame into a video file as fast as decoding allows
+    bool exportVideo(const std::string& videoPath, const std::string& exportPath, int width = 0, int height = 0) {
+        auto start_time = std::chrono::steady_clock::now();
+        // The output has no terminal to size from
+        current_width = width > 0 ? width : 120;
+        current_height = height > 0 ? height : 40;
+        loop_video = false;
+        if (playlist.empty() || playlist.front() != videoPath) {
+            playlist = {videoPath};
+        }
+        
+        std::unique_ptr<FrameSource> source = FrameSource::open(videoPath);
+        if (!source) {
+            std::cerr << "Error: Failed to open video file: " << videoPath << std::endl;
+            return false;
+        }
+        double fps = 1000.0 / nominalFrameInterval(source->fps());
+        VideoExporter exporter;
+        exporter.open(exportPath, fps);
+        export_mode = true;
+        startBuffering(std::move(source));
+        
+        size_t frames = 0;
+        bool ok = true;
+        while (ok) {
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            if (frame_buffer.empty()) {
+                if (!buffer_running) break;
+                buffer_cv.wait_for(lock, std::chrono::milliseconds(100));
+                continue;
+            }
+            BufferedFrame bf = std::move(frame_buffer.front());
+            frame_buffer.erase(frame_buffer.begin());
+            lock.unlock();
+            
+            ok = exporter.write(bf.cells);
+            first_paint_done = true;
+            if (ok && ++frames % 50 == 0) {
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                std::cout << "\rExported " << frames << " frames (" << std::fixed << std::setprecision(1)
+                          << (elapsed > 0 ? frames / fps / elapsed : 0.0) << "x real time)   " << std::flush;
+            }
+        }
+        
+        buffer_running = false;
+        if (buffer_thread.joinable()) {
+            buffer_thread.join();
+        }
+        frame_buffer.clear();
+        export_mode = false;
+        ok = exporter.close() && ok;
+        if (!ok) return false;
+        
+        double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        double video_s = frames / fps;
+        std::cout << "\rExported " << frames << " frames to " << exportPath << "\n" << std::fixed << std::setprecision(2)
+                  << "Video: " << exporter.frameSize().width << "x" << exporter.frameSize().height << " at " << fps
+                  << " fps, " << video_s << " s\n"
+                  << "Time: " << total_s << " s (" << (total_s > 0 ? video_s / total_s : 0.0) << "x real time)\n";
+        printIoStats();
+        printMemoryStats();
+        return true;
+    }
+
+    // Spread playback over several terminals, all presenting each frame at the same moment
+    bool playVideoWall(const std::string& videoPath, const std::vector<std::string>& outputs,
+                       int columns, int width = 0, int height = 0) {
+        VideoWall wall;
+        if (!wall.open(outputs, columns)) return false;
+        // One grid for the whole wall, sliced into tiles after the single resize
+        current_width = width > 0 ? width : wall.tileWidth() * wall.columns();
+        current_height = height > 0 ? height : wall.tileHeight() * wall.rows();
+        if (playlist.empty() || playlist.front() != videoPath) {
+            playlist = {videoPath};
+        }
+        
+        std::unique_ptr<FrameSource> source = FrameSource::open(videoPath);
+        if (!source) {
+            std::cerr << "Error: Failed to open video file: " << videoPath << std::endl;
+            return false;
+        }
+        displayVideoInfo(*source);
+        std::cout << "Wall: " << outputs.size() << " outputs as " << wall.columns() << "x" << wall.rows()
+                  << " tiles, grid " << current_width << "x" << current_height << ". Press Q to stop.\n";
+        
+        auto interval = std::chrono::duration_cast<VideoWall::Clock::duration>(
+            std::chrono::duration<double, std::milli>(nominalFrameInterval(source->fps())));
+        frame_interval_ms = std::chrono::duration<double, std::milli>(interval).count();
+        wall_mode = true;
+        startBuffering(std::move(source));
+        TerminalGuard guard(original_termios, terminal_modified);
+        
+        // Frames are due at their own timestamps; writers get one interval to stage each one
+        PresentationClock clock;
+        VideoWall::Clock::time_point wall_start = VideoWall::Clock::now();
+        size_t frames = 0;
+        bool starved = false;
+        while (true) {
+            char key;
+            if (kbhit() && read(STDIN_FILENO, &key, 1) > 0 && (key == 'q' || key == 'Q' || key == 27)) break;
+            
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            if (frame_buffer.empty()) {
+                if (!buffer_running) break;
+                if (first_paint_done && !starved) depth_controller.noteUnderrun();
+                starved = true;
+                buffer_cv.wait_for(lock, std::chrono::milliseconds(100));
+                continue;
+            }
+            starved = false;
+            BufferedFrame bf = std::move(frame_buffer.front());
+            frame_buffer.erase(frame_buffer.begin());
+            lock.unlock();
+            
+            // Behind schedule (slow decode or a slow output), the clock restarts
+            double now_ms = std::chrono::duration<double, std::milli>(VideoWall::Clock::now() - wall_start).count();
+            if (bf.starts_item) clock.join(bf.media_ms, source_interval_ms);
+            auto due = std::chrono::duration_cast<VideoWall::Clock::duration>(
+                std::chrono::duration<double, std::milli>(clock.due(bf.media_ms, now_ms)));
+            wall.present(bf.cells, wall_start + due + interval);
+            first_paint_done = true;
+            if (++frames % 25 == 0) {
+                VideoWall::Stats stats = wall.stats();
+                std::cout << "\rFrame " << frames << "  skew avg " << std::fixed << std::setprecision(2)
+                          << stats.skew_avg_ms << " ms, max " << stats.skew_max_ms << " ms, late "
+                          << stats.late_frames << "   " << std::flush;
+            }
+        }
+        
+        buffer_running = false;
+        if (buffer_thread.joinable()) {
+            buffer_thread.join();
+        }
+        frame_buffer.clear();
+        wall_mode = false;
+        wall.finish();
+        VideoWall::Stats stats = wall.stats();
+        wall.close();
+        std::cout << "\n\nWall playback finished!\n"
+                  << "Frames: " << stats.frames << ", " << stats.late_frames << " late\n"
+                  << "Skew: avg " << std::fixed << std::setprecision(2) << stats.skew_avg_ms
+                  << " ms, max " << stats.skew_max_ms << " ms\n"
+                  << "Output: " << (stats.frames > 0 ? stats.bytes / stats.frames : 0) << " bytes/frame\n";
+        if (stats.failed_outputs > 0) std::cout << "Failed outputs: " << stats.failed_outputs << "\n";
+        printIoStats();
+        printMemoryStats();
+        return true;
+    }
+
+    // Send the cells to viewers over a socket or pipe as binary deltas, paced
+    // like playback, and measure that against ANSI for the same frames
+    bool streamVideo(const std::string& videoPath, const std::string& target, int width = 0, int height = 0) {
+        // The viewers' terminals are elsewhere; their size comes from the options
+        current_width = width > 0 ? width : 120;
+        current_height = height > 0 ? height : 40;
+        if (playlist.empty() || playlist.front() != videoPath) {
+            playlist = {videoPath};
+        }
+        
+        std::unique_ptr<FrameSource> source = FrameSource::open(videoPath);
+        if (!source) {
+            std::cerr << "Error: Failed to open video file: " << videoPath << std::endl;
+            return false;
+        }
+        displayVideoInfo(*source);
+        // A viewer closing the pipe is an error to report, not a reason to die
+        signal(SIGPIPE, SIG_IGN);
+        std::cout << "Waiting for a viewer on " << target << "..." << std::endl;
+        StreamOutput output;
+        if (!output.open(target)) return false;
+        std::cout << "Streaming a " << current_width << "x" << current_height << " grid. Press Q to stop.\n";
+        
+        stream_mode = true;
+        startBuffering(std::move(source));
+        TerminalGuard guard(original_termios, terminal_modified);
+        
+        PresentationClock clock;
+        auto start = std::chrono::steady_clock::now();
+        CellStreamEncoder encoder;
+        // The same frames as escapes: changed cells only, and full redraws
+        DeltaEncoder ansi_delta, ansi_full;
+        size_t ansi_delta_bytes = 0, ansi_full_bytes = 0;
+        size_t frames = 0;
+        bool starved = false;
+        std::string message, ansi;
+        while (true) {
+            char key;
+            if (kbhit() && read(STDIN_FILENO, &key, 1) > 0 && (key == 'q' || key == 'Q' || key == 27)) break;
+            
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            if (frame_buffer.empty()) {
+                if (!buffer_running) break;
+                if (first_paint_done && !starved) depth_controller.noteUnderrun();
+                starved = true;
+                buffer_cv.wait_for(lock, std::chrono::milliseconds(100));
+                continue;
+            }
+            starved = false;
+            BufferedFrame bf = std::move(frame_buffer.front());
+            frame_buffer.erase(frame_buffer.begin());
+            lock.unlock();
+            
+            double now_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (bf.starts_item) clock.join(bf.media_ms, source_interval_ms);
+            double due_ms = clock.due(bf.media_ms, now_ms);
+            if (due_ms > now_ms) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(due_ms - now_ms));
+            
+            if (output.poll()) encoder.requestKeyframe();
+            message.clear();
+            encoder.encode(bf.cells, message);
+            if (!output.send(message)) break;
+            first_paint_done = true;
+            
+            ansi.clear();
+            ansi_delta.encode(bf.cells, ansi);
+            ansi_delta_bytes += ansi.size();
+            ansi.clear();
+            ansi_full.reset();
+            ansi_full.encode(bf.cells, ansi);
+            ansi_full_bytes += ansi.size();
+            
+            if (++frames % 25 == 0) {
+                std::cout << "\rFrame " << frames << "  viewers " << output.viewers() << "  "
+                          << encoder.stats().bytes / frames << " bytes/frame (ANSI " << ansi_delta_bytes / frames
+                          << ")   " << std::flush;
+            }
+        }
+        
+        buffer_running = false;
+        if (buffer_thread.joinable()) {
+            buffer_thread.join();
+        }
+        frame_buffer.clear();
+        stream_mode = false;
+        output.close();
+        
+        const CellStreamEncoder::Stats& stats = encoder.stats();
+        size_t per_frame = frames > 0 ? stats.bytes / frames : 0;
+        auto ratio = [&](size_t bytes) { return stats.bytes > 0 ? static_cast<double>(bytes) / stats.bytes : 0.0; };
+        std::cout << "\n\nStream finished!\n"
+                  << "Frames: " << frames << ", " << stats.keyframes << " keyframes, "
+                  << output.viewersSeen() << " viewers\n"
+                  << "Stream: " << per_frame << " bytes/frame, " << MemoryGovernor::formatSize(output.bytesSent())
+                  << " sent\n" << std::fixed << std::setprecision(1)
+                  << "ANSI: " << (frames > 0 ? ansi_delta_bytes / frames : 0) << " bytes/frame changed cells ("
+                  << ratio(ansi_delta_bytes) << "x), " << (frames > 0 ? ansi_full_bytes / frames : 0)
+                  << " bytes/frame full redraws (" << ratio(ansi_full_bytes) << "x)\n";
+        printIoStats();
+        printMemoryStats();
+        return true;
+    }
+
+    double scrubStep() const {
+        return thumbnail_interval_ms > 0.0 ? thumbnail_interval_ms : DEFAULT_SCRUB_STEP_MS;
+    }
+    
+    static std::string formatMediaTime(double ms) {
+        long seconds = static_cast<long>(std::max(ms, 0.0) / 1000.0);
+        long minutes = seconds / 60;
+        std::ostringstream text;
+        text << std::setfill('0');
+        if (minutes >= 60) text << minutes / 60 << ":" << std::setw(2) << minutes % 60;
+        else text << minutes;
+        text << ":" << std::setw(2) << seconds % 60;
+        return text.str();
+    }
+    
+    // The thumbnail nearest the scrub position, boxed over the bottom of the
+    // frame on screen (`rows` tall), and a seek bar in place of the status
+    void drawScrubPreview(double position_ms, double length_ms, int rows, bool indexed) {
+        static const int BAR_WIDTH = 40;
+        std::string out;
+        ThumbnailIndex::Thumbnail thumbnail;
+        bool found = indexed && thumbnails.nearest(position_ms, thumbnail) &&
+                     std::abs(thumbnail.media_ms - position_ms) <= scrubStep();
+        if (found) {
+            int box_width = thumbnail.cells.width() + 2;
+            int box_height = thumbnail.cells.height() + 2;
+            int column = std::max((getTerminalSize().width - box_width) / 2 + 1, 1);
+            ThumbnailIndex::appendPreview(thumbnail.cells, std::max(rows - box_height + 1, 1), column, out);
+        }
+        
+        int filled = length_ms > 0.0 ? static_cast<int>(std::min(position_ms / length_ms, 1.0) * BAR_WIDTH) : 0;
+        out += resetColor() + "\033[" + std::to_string(rows + 1) + ";1H\033[J\n[SEEK] " +
+               formatMediaTime(position_ms) + (length_ms > 0.0 ? " / " + formatMediaTime(length_ms) : "") +
+               " [" + std::string(filled, '=') + "|" + std::string(BAR_WIDTH - filled, '-') + "] ";
+        if (!indexed) {
+            out += "(previews off)";
+        } else if (found) {
+            out += "preview at " + formatMediaTime(thumbnail.media_ms);
+        } else {
+            out += "indexing " + std::to_string(static_cast<int>(thumbnails.progress() * 100)) + "%";
+        }
+        out += "\n[,/.]Seek, playback continues from here when the keys stop";
+        std::cout << out << std::flush;
+    }
+
     // Modify playVideoAscii method
     bool playVideoAscii(const std::string& videoPath, int width = 0, int height = 0) {
         // Store original dimensions
@@ -469,107 +1190,333 @@ public:
         current_width = width;
         current_height = height;
 
-        cv::VideoCapture cap(videoPath);
-        if (!cap.isOpened()) {
+        if (playlist.empty() || playlist.front() != videoPath) {
+            playlist = {videoPath};
+        }
+
+        std::unique_ptr<FrameSource> source = FrameSource::open(videoPath);
+        if (!source) {
             std::cerr << "Error: Failed to open video file: " << videoPath << std::endl;
             return false;
         }
 
-        displayVideoInfo(cap);
-        TerminalGuard guard(original_termios, terminal_modified);
+        displayVideoInfo(*source);
+        if (!session) session = Session::live("");
         
-        double fps = cap.get(cv::CAP_PROP_FPS);
-        double base_delay = (fps > 0.0) ? (1000.0 / fps) : 33.33;
+        // Frames are shown at their own timestamps; the container rate is only a fallback
+        source_interval_ms = nominalFrameInterval(source->fps());
+        PresentationClock clock;
         double speed_multiplier = 1.0;
         bool paused = false, fullscreen_mode = false;
-        int frame_number = 0, total_frames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+        int frame_number = 0, total_frames = source->frameCount();
+        int shown_item = 0;
         
-        // Initialize frame buffer
-        buffer_running = true;
-        frame_buffer.reserve(FRAME_BUFFER_SIZE);
-        buffer_thread = std::thread(&ASCIIVideoPlayer::bufferFrames, this, std::ref(cap));
+        // Start decoding right away so the buffer fills while the info screen is up
+        startBuffering(std::move(source));
+        if (prompt_before_play) waitForStart();
+        TerminalGuard guard(original_termios, terminal_modified);
 
-        auto last_time = std::chrono::steady_clock::now();
+        session->start();
+        bool starved = false;
+        bool item_joined = false;
+        
+        // Scrub position while seek keys are coming, and what is on screen
+        bool scrubbing = false, awaiting_seek = false;
+        double scrub_ms = 0.0, scrub_key_ms = 0.0, seek_start_ms = 0.0, shown_media_ms = 0.0;
+        int scrub_item = 0, shown_rows = 0;
+        thumbnail_item = -1;
+        seek_count = 0;
+        seek_time_total_ms = 0.0;
+
+        // Display status
+        auto printStatus = [&](size_t buffered) {
+            std::string color_mode_str = (current_color_mode == MONO ? "MONO" : 
+                                        current_color_mode == COLOR_8BIT ? "8BIT" : "24BIT");
+            int progress = (total_frames > 0) ? (frame_number * 100 / total_frames) : 0;
+            std::cout << resetColor() << "\n[" << (paused ? "PAUSED" : "PLAYING") << "] "
+                     << "Frame: " << frame_number << "/" << total_frames
+                     << " (" << progress << "%) "
+                     << "Speed: " << std::fixed << std::setprecision(1) << speed_multiplier << "x "
+                     << "Mode: " << color_mode_str << (block_mode ? "-BLOCK" : "")
+                     << (fullscreen_mode ? " FULLSCREEN" : "")
+                     << " Loop: " << (loop_video ? "ON" : "OFF")
+                     << (playlist.size() > 1 ? " Item: " + std::to_string(shown_item + 1) + "/" + std::to_string(playlist.size()) : "")
+                     << " Zoom: " << zoomLevel() << "x"
+                     << " Buffer: " << buffered << "/" << bufferLimit()
+                     << (memory.enabled() ? " Mem: " + MemoryGovernor::formatSize(memory.usage()) + "/" +
+                                            MemoryGovernor::formatSize(memory.budget()) : "")
+                     << "\n[Q]Quit [SPACE]Pause [L]Loop [+/-]Speed [C]Color [B]Block [F]Fullscreen [Z/X]Zoom [WASD]Pan [0]Reset view [,/.]Seek";
+        };
 
         while (buffer_running || !frame_buffer.empty()) {
-            if (kbhit()) {
-                char key;
-                while (read(STDIN_FILENO, &key, 1) > 0) {
-                    switch (key) {
-                        case 'q': case 'Q': case 27: 
-                            buffer_running = false;
-                            goto cleanup;
-                        case ' ': paused = !paused; break;
-                        case 'l': case 'L': loop_video = !loop_video; break;
-                        case '+': case '=': speed_multiplier = std::min(speed_multiplier * 1.5, 5.0); break;
-                        case '-': case '_': speed_multiplier = std::max(speed_multiplier / 1.5, 0.2); break;
-                        case 'c': case 'C': 
-                            setColorMode(static_cast<ColorMode>((current_color_mode + 1) % 3)); 
-                            break;
-                        case 'b': case 'B': block_mode = !block_mode; break;
-                        case 'f': case 'F':
-                            fullscreen_mode = !fullscreen_mode;
-                            if (fullscreen_mode) {
-                                TerminalSize term = getTerminalSize();
-                                width = term.width - 2;
-                                height = term.height - 4;
-                            } else {
-                                width = original_width;
-                                height = original_height;
-                            }
-                        case 'r': case 'R':
-                            clearColorCaches();
-                            break;
+            SessionEvent event;
+            bool render_changed = false;
+            while (session->poll(event)) {
+                if (event.type == SessionEvent::RESIZE) {
+                    if (fullscreen_mode) {
+                        current_width = event.cols - 2;
+                        current_height = event.rows - 4;
+                    }
+                    render_changed = true;
+                    delta_encoder.reset();
+                    interlace_full_requested = true;
+                    {
+                        std::lock_guard<std::mutex> buffer_lock(buffer_mutex);
+                        refield_requested = interlace;
                     }
+                    continue;
+                }
+                switch (event.key) {
+                    case 'q': case 'Q': case 27: 
+                        buffer_running = false;
+                        goto cleanup;
+                    case ' ':
+                        paused = !paused;
+                        if (paused) startRefinement();
+                        else stopRefinement();
+                        // Refinement drew over the screen behind the encoder's back,
+                        // and over the rows the next interlaced field would skip
+                        if (!paused) {
+                            delta_encoder.reset();
+                            interlace_full_requested = true;
+                            std::lock_guard<std::mutex> buffer_lock(buffer_mutex);
+                            refield_requested = interlace;
+                        }
+                        clock.restart();
+                        break;
+                    case 'l': case 'L': loop_video = !loop_video; break;
+                    case '+': case '=': speed_multiplier = std::min(speed_multiplier * 1.5, 5.0); break;
+                    case '-': case '_': speed_multiplier = std::max(speed_multiplier / 1.5, 0.2); break;
+                    case 'c': case 'C': 
+                        setColorMode(static_cast<ColorMode>((current_color_mode + 1) % 3)); 
+                        render_changed = true;
+                        break;
+                    case 'b': case 'B': block_mode = !block_mode; render_changed = true; break;
+                    case 'f': case 'F':
+                        fullscreen_mode = !fullscreen_mode;
+                        render_changed = true;
+                        // The buffer thread renders at the current size
+                        if (fullscreen_mode) {
+                            TerminalSize term = getTerminalSize();
+                            current_width = term.width - 2;
+                            current_height = term.height - 4;
+                        } else {
+                            current_width = original_width;
+                            current_height = original_height;
+                        }
+                    case 'r': case 'R':
+                        clearColorCaches();
+                        break;
+                    case ',': case '<': case '.': case '>': {
+                        if (!scrubbing && !awaiting_seek) {
+                            scrub_ms = shown_media_ms;
+                            scrub_item = shown_item;
+                        }
+                        scrubbing = true;
+                        double length_ms = total_frames > 0 ? total_frames * source_interval_ms : 0.0;
+                        scrub_ms += (event.key == ',' || event.key == '<') ? -scrubStep() : scrubStep();
+                        scrub_ms = std::max(length_ms > 0.0 ? std::min(scrub_ms, length_ms) : scrub_ms, 0.0);
+                        scrub_key_ms = session->now();
+                        drawScrubPreview(scrub_ms, length_ms, shown_rows,
+                                         thumbnail_interval_ms > 0.0 && thumbnail_item == scrub_item);
+                        break;
+                    }
+                    default:
+                        if (handleViewKey(event.key)) render_changed = true;
+                        break;
+                }
+            }
+            // Refine again with the new settings
+            if (paused && render_changed) startRefinement();
+            clock.setSpeed(speed_multiplier);
+            frame_interval_ms = source_interval_ms / speed_multiplier;
+            
+            if (scrubbing) {
+                if (session->now() - scrub_key_ms < SCRUB_SETTLE_MS) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+                // Keys stopped: the buffer thread decodes the real frame there
+                scrubbing = false;
+                awaiting_seek = true;
+                seek_request_item = scrub_item;
+                seek_request_ms = scrub_ms;
+                seek_start_ms = session->now();
+                if (paused) {
+                    paused = false;
+                    stopRefinement();
                 }
             }
 
             if (!paused) {
                 std::unique_lock<std::mutex> lock(buffer_mutex);
                 if (frame_buffer.empty()) {
+                    // Count each dry spell once, not every wakeup
+                    if (buffer_running && first_paint_done && !starved) depth_controller.noteUnderrun();
+                    starved = true;
                     buffer_cv.wait_for(lock, std::chrono::milliseconds(100));
                     continue;
                 }
+                starved = false;
 
                 auto& bf = frame_buffer.front();
-                std::cout << "\033[2J\033[H" << bf.ascii_output;
+                if (awaiting_seek && !bf.after_seek) {
+                    // Decoded before the buffer thread took the seek
+                    frame_buffer.erase(frame_buffer.begin());
+                    continue;
+                }
+                if (refield_requested && bf.field >= 0 && buffer_running) {
+                    // Drawn whole by the buffer thread in a moment
+                    lock.unlock();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                if (bf.after_seek && awaiting_seek) {
+                    // A new timeline from the seek target, drawn on a clean screen
+                    awaiting_seek = false;
+                    clock.restart();
+                    item_joined = false;
+                    delta_encoder.reset();
+                    std::cout << "\033[2J";
+                    shown_item = bf.source_index;
+                    total_frames = bf.source_frames;
+                    frame_number = static_cast<int>(bf.media_ms / std::max(source_interval_ms.load(), 1.0));
+                    seek_count++;
+                    seek_time_total_ms += session->now() - seek_start_ms;
+                }
+                if (bf.starts_item && !item_joined) {
+                    // Gapless: the item's first frame comes one interval after the last one
+                    clock.join(bf.media_ms, source_interval_ms);
+                    item_joined = true;
+                }
+                double now = session->now();
+                double due = clock.due(bf.media_ms, now);
+                if (due > now) {
+                    // Not yet; short naps keep the controls responsive during long frames
+                    lock.unlock();
+                    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(std::min(due - now, 50.0)));
+                    continue;
+                }
+                if (bf.starts_item) {
+                    // Next item (or loop restart) reached the screen
+                    shown_item = bf.source_index;
+                    item_joined = false;
+                    frame_number = 0;
+                    total_frames = bf.source_frames;
+                }
+                if (delta_mode) {
+                    // Changed cells only, then clear below the grid for the status line
+                    std::string encoded;
+                    delta_encoder.encode(bf.cells, encoded);
+                    const DeltaEncoder::Stats& stats = delta_encoder.lastStats();
+                    delta_bytes_total += stats.bytes;
+                    delta_frames++;
+                    if (stats.regions_deferred > 0) delta_deferred_frames++;
+                    std::cout << encoded << "\033[" << bf.cells.height() + 1 << ";1H\033[J";
+                } else if (sixel_mode) {
+                    // The image covers the old one, so no clear (and no flicker)
+                    std::cout << "\033[H" << bf.ascii_output << "\r\033[J";
+                } else if (kitty_mode) {
+                    std::string command = "\033[H";
+                    if (kitty_encoder.present(bf.pixels, command)) {
+                        kitty_bytes_total += command.size();
+                        kitty_shm_total += bf.pixels.total() * bf.pixels.elemSize();
+                    } else {
+                        kitty_failures++;
+                    }
+                    std::cout << command << "\033[" << bf.rows + 1 << ";1H\033[J";
+                } else if (bf.field >= 0) {
+                    // Rows of one field over the previous frame, which shows through in between
+                    std::cout << bf.ascii_output << "\033[" << bf.rows + 1 << ";1H\033[J";
+                } else {
+                    std::cout << "\033[2J\033[H" << bf.ascii_output;
+                }
+                last_frame = bf.frame;
+                last_frame_bytes = last_frame.total() * last_frame.elemSize();
+                last_crop = bf.crop;
                 frame_number++;
+                first_paint_done = true;
+                shown_media_ms = bf.media_ms;
+                shown_rows = bf.rows;
 
-                // Display status
-                std::string color_mode_str = (current_color_mode == MONO ? "MONO" : 
-                                            current_color_mode == COLOR_8BIT ? "8BIT" : "24BIT");
-                int progress = (total_frames > 0) ? (frame_number * 100 / total_frames) : 0;
-                std::cout << resetColor() << "\n[" << (paused ? "PAUSED" : "PLAYING") << "] "
-                         << "Frame: " << frame_number << "/" << total_frames
-                         << " (" << progress << "%) "
-                         << "Speed: " << std::fixed << std::setprecision(1) << speed_multiplier << "x "
-                         << "Mode: " << color_mode_str << (block_mode ? "-BLOCK" : "")
-                         << (fullscreen_mode ? " FULLSCREEN" : "")
-                         << " Loop: " << (loop_video ? "ON" : "OFF")
-                         << " Buffer: " << frame_buffer.size() << "/" << FRAME_BUFFER_SIZE
-                         << "\n[Q]Quit [SPACE]Pause [L]Loop [+/-]Speed [C]Color [B]Block [F]Fullscreen";
+                printStatus(frame_buffer.size());
+                session->frameShown();
                 
                 frame_buffer.erase(frame_buffer.begin());
                 lock.unlock();
-
-                // Frame timing control
-                double current_delay = base_delay / speed_multiplier;
-                auto now = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time).count();
-                if (elapsed < current_delay) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(current_delay - elapsed)));
+                
+                // Index the item on screen once it plays, so scrubbing has previews
+                if (thumbnail_interval_ms > 0.0 && thumbnail_item != shown_item) {
+                    thumbnail_item = shown_item;
+                    thumbnails.start(playlist[shown_item], thumbnail_interval_ms, current_color_mode,
+                                     block_mode && current_color_mode != MONO);
                 }
-                last_time = std::chrono::steady_clock::now();
+            } else {
+                if (refine_ready) {
+                    size_t buffered;
+                    {
+                        std::lock_guard<std::mutex> buffer_lock(buffer_mutex);
+                        buffered = frame_buffer.size();
+                    }
+                    // Same grid as the frame on screen, so overwrite in place instead of clearing
+                    std::lock_guard<std::mutex> lock(refine_mutex);
+                    std::cout << "\033[H" << refined_output;
+                    printStatus(buffered);
+                    std::cout << std::flush;
+                    refine_ready = false;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
         }
 
     cleanup:
+        stopRefinement();
+        thumbnails.stop();
         buffer_running = false;
         if (buffer_thread.joinable()) {
             buffer_thread.join();
         }
         frame_buffer.clear();
         std::cout << resetColor() << "\n\nPlayback finished!\n";
+        if (transition_count > 0) {
+            std::cout << "Transitions: " << transition_count
+                      << " (gap avg " << std::fixed << std::setprecision(2)
+                      << transition_gap_total_ms / transition_count << " ms, max "
+                      << transition_gap_max_ms << " ms)\n";
+        }
+        if (seek_count > 0) {
+            std::cout << "Seeks: " << seek_count << " (avg " << std::fixed << std::setprecision(2)
+                      << seek_time_total_ms / seek_count << " ms to the first frame)\n";
+        }
+        if (thumbnails.count() > 0) {
+            std::cout << "Thumbnails: " << thumbnails.count() << " in "
+                      << MemoryGovernor::formatSize(thumbnails.memoryUsage()) << "\n";
+        }
+        if (AnimationCache::animations() > 0) {
+            std::cout << "Animation cache: " << AnimationCache::animations() << " decoded once, "
+                      << AnimationCache::frames() << " frames in "
+                      << MemoryGovernor::formatSize(AnimationCache::memoryUsage()) << "\n";
+        }
+        std::cout << "Buffer depth: avg " << std::fixed << std::setprecision(1) << depth_controller.averageDepth()
+                  << " (" << depth_controller.minDepth() << "-" << depth_controller.maxDepth() << "), "
+                  << depth_controller.underruns() << " underruns\n";
+        if (delta_frames > 0) {
+            std::cout << "Delta: " << delta_bytes_total / delta_frames << " bytes/frame"
+                      << (delta_encoder.getBudget() > 0 ? " (budget " + std::to_string(delta_encoder.getBudget()) + ")" : "")
+                      << ", " << delta_deferred_frames << " frames carried changes over\n";
+        }
+        if (kitty_mode) {
+            size_t shown = kitty_encoder.framesSent();
+            std::cout << "Kitty: " << (shown > 0 ? kitty_bytes_total / shown : 0) << " bytes/frame through the terminal, "
+                      << MemoryGovernor::formatSize(shown > 0 ? kitty_shm_total / shown : 0)
+                      << "/frame through shared memory";
+            if (kitty_failures > 0) std::cout << ", " << kitty_failures << " frames could not be written";
+            std::cout << "\n";
+            std::cout << kitty_encoder.deleteCommand();
+            kitty_encoder.cleanup();
+        }
+        printIoStats();
+        printMemoryStats();
         return true;
     }
     
@@ -624,7 +1571,7 @@ public:
                                         current_color_mode == COLOR_8BIT ? "8BIT" : "24BIT");
             std::cout << resetColor() << "Mode: " << color_mode_str << (block_mode ? "-BLOCK" : "")
                       << (fullscreen_mode ? " FULLSCREEN" : "")
-                      << " | Cache: " << std::fixed << std::setprecision(1) << cache_stats.hit_rate() << "%"
+                      << " | Cache: " << std::fixed << std::setprecision(1) << getCacheStats().hit_rate() << "%"
                       << " | [Q]uit [C]olor [B]lock [F]ullscreen [S]tats [R]eset" << std::flush;
             
             auto now = std::chrono::steady_clock::now();
@@ -640,7 +1587,25 @@ public:
     
     // Add these near other public methods
     void setLoopEnabled(bool enabled) { loop_video = enabled; }
+    void setPlaylist(const std::vector<std::string>& items) { playlist = items; }
+    void setPromptEnabled(bool enabled) { prompt_before_play = enabled; }
+    double zoomLevel() {
+        std::lock_guard<std::mutex> lock(viewport_mutex);
+        return viewport.zoomLevel();
+    }
+    void setAutoCrop(bool enabled) { autocrop = enabled; crop_detector.reset(); }
     void setBlockMode(bool enabled) { block_mode = enabled; }
+    void setSession(std::unique_ptr<Session> s) { session = std::move(s); }
+    void setMemoryBudget(size_t bytes) { memory.setBudget(bytes); }
+    void setThumbnailInterval(double seconds) { thumbnail_interval_ms = std::max(seconds, 0.0) * 1000.0; }
+    void setBufferDepth(size_t min_depth, size_t max_depth) { depth_controller.setLimits(min_depth, max_depth); }
+    void setInterlaced(bool enabled) { interlace = enabled; }
+    void setSixelMode(bool enabled) { sixel_mode = enabled; }
+    void setKittyMode(bool enabled) { kitty_mode = enabled; }
+    void setDeltaMode(bool enabled, size_t max_frame_bytes) {
+        delta_mode = enabled;
+        delta_encoder.setBudget(max_frame_bytes);
+    }
     
     // Add static conversion method
     static ColorMode convertColorMode(PlayerConfig::ColorMode mode) {
@@ -652,8 +1617,13 @@ public:
     }
 };
 
-// Static member definition
-ASCIIVideoPlayer* ASCIIVideoPlayer::instance = nullptr;
+// Signal handler for clean exit
+static void signalHandler(int signal) {
+    // Destructors don't run on this path; shared memory would outlive us
+    KittyEncoder::cleanupAll();
+    std::cout << "\033[?25h\033[?1049l\033[0m\n";
+    std::exit(signal);
+}
 
 int main(int argc, char* argv[]) {
     PlayerConfig config;
@@ -664,12 +1634,53 @@ int main(int argc, char* argv[]) {
         config = PlayerConfig::fromInteractive();
     }
     
+    // Set up signal handlers for clean exit
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+    signal(SIGQUIT, signalHandler);
+    
     ASCIIVideoPlayer player;
     player.setColorMode(ASCIIVideoPlayer::convertColorMode(config.colorMode));
     player.setLoopEnabled(config.autoLoop);
     player.setBlockMode(config.blockMode);
+    player.setPlaylist(config.playlist);
+    
+    player.setPromptEnabled(!config.noPrompt);
+    player.setAutoCrop(config.autoCrop);
+    player.setMemoryBudget(config.memoryBudget);
+    player.setThumbnailInterval(config.thumbnailInterval);
+    player.setBufferDepth(config.bufferMin, config.bufferMax);
+    player.setDeltaMode(config.deltaMode, config.maxFrameBytes);
+    player.setInterlaced(config.interlace);
+    player.setSixelMode(config.sixel);
+    player.setKittyMode(config.kitty);
     
-    if (!config.videoPath.empty()) {
+    if (!config.replaySessionPath.empty()) {
+        std::unique_ptr<Session> session = Session::replay(config.replaySessionPath);
+        if (!session) return -1;
+        player.setSession(std::move(session));
+    } else if (!config.recordSessionPath.empty()) {
+        player.setSession(Session::live(config.recordSessionPath));
+    }
+    
+    if (!config.exportPath.empty() && !config.videoPath.empty()) {
+        if (!player.exportVideo(config.videoPath, config.exportPath, config.width, config.height)) {
+            return -1;
+        }
+    } else if (config.benchMode && !config.videoPath.empty()) {
+        if (!player.benchmarkVideo(config.videoPath, config.width, config.height)) {
+            return -1;
+        }
+    } else if (!config.videoPath.empty() && !config.streamTarget.empty()) {
+        if (!player.streamVideo(config.videoPath, config.streamTarget, config.width, config.height)) {
+            return -1;
+        }
+    } else if (!config.videoPath.empty() && !config.wallOutputs.empty()) {
+        if (!player.playVideoWall(config.videoPath, config.wallOutputs, config.wallColumns,
+                                  config.width, config.height)) {
+            return -1;
+        }
+    } else if (!config.videoPath.empty()) {
         if (!player.playVideoAscii(config.videoPath, config.width, config.height)) {
             return -1;
         }
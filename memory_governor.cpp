@@ -0,0 +1,136 @@
+#include "memory_governor.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+MemoryGovernor::MemoryGovernor(size_t budget) : budget_bytes(budget) {}
+
+void MemoryGovernor::add(Consumer consumer) {
+    consumers.push_back(std::move(consumer));
+}
+
+void MemoryGovernor::clear() {
+    consumers.clear();
+    settling = false;
+    exhausted = false;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    last_breakdown.clear();
+    last_total = 0;
+}
+
+void MemoryGovernor::enforce() {
+    std::vector<Entry> entries(consumers.size());
+    size_t total = 0;
+    for (size_t i = 0; i < consumers.size(); ++i) {
+        entries[i].name = consumers[i].name;
+        entries[i].bytes = consumers[i].usage ? consumers[i].usage() : 0;
+        total += entries[i].bytes;
+    }
+
+    size_t measured = total;
+    size_t shrinks = 0;
+    if (budget_bytes > 0 && total > budget_bytes && settling && total < settle_total) {
+        // The last limit is still paying off; wait for it to level out
+        settle_total = total;
+    } else if (budget_bytes > 0 && total > budget_bytes && exhausted &&
+               total <= exhausted_total + budget_bytes / 8) {
+        // Shrinking again would only throw away what just refilled
+    } else if (budget_bytes > 0 && total > budget_bytes) {
+        // Lowest priority first, then the largest; each is asked for the whole excess
+        settling = false;
+        std::vector<size_t> order(consumers.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this, &entries](size_t a, size_t b) {
+            if (consumers[a].priority != consumers[b].priority) return consumers[a].priority < consumers[b].priority;
+            return entries[a].bytes > entries[b].bytes;
+        });
+        for (size_t i : order) {
+            if (total <= budget_bytes) break;
+            if (consumers[i].shrink) {
+                size_t freed = std::min(consumers[i].shrink(total - budget_bytes), entries[i].bytes);
+                if (freed > 0) {
+                    entries[i].bytes -= freed;
+                    total -= freed;
+                    shrinks++;
+                    continue;
+                }
+            }
+            if (consumers[i].limit && consumers[i].limit()) {
+                // Nothing was freed yet, so the others are spared until it settles
+                shrinks++;
+                settling = true;
+                settle_total = total;
+                break;
+            }
+        }
+        exhausted = !settling && total > budget_bytes;
+        exhausted_total = measured;
+    } else if (budget_bytes > 0 && total < budget_bytes / 2) {
+        // Plenty of room: let the most important consumers grow back first
+        settling = false;
+        exhausted = false;
+        for (auto it = consumers.rbegin(); it != consumers.rend(); ++it) {
+            if (it->relax) it->relax();
+        }
+    } else {
+        settling = false;
+        exhausted = false;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    last_breakdown = std::move(entries);
+    last_total = total;
+    peak_total = std::max(peak_total, measured);
+    shrink_events += shrinks;
+}
+
+std::vector<MemoryGovernor::Entry> MemoryGovernor::breakdown() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return last_breakdown;
+}
+
+size_t MemoryGovernor::usage() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return last_total;
+}
+
+size_t MemoryGovernor::shrinkCount() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return shrink_events;
+}
+
+size_t MemoryGovernor::peak() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return peak_total;
+}
+
+size_t MemoryGovernor::parseSize(const std::string& text) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || value <= 0) return 0;
+    std::string suffix(end);
+    if (!suffix.empty() && (suffix.back() == 'B' || suffix.back() == 'b')) suffix.pop_back();
+    double scale = 1;
+    if (suffix.size() == 1) {
+        switch (std::toupper(static_cast<unsigned char>(suffix[0]))) {
+            case 'K': scale = 1024.0; break;
+            case 'M': scale = 1024.0 * 1024; break;
+            case 'G': scale = 1024.0 * 1024 * 1024; break;
+            default: return 0;
+        }
+    } else if (!suffix.empty()) {
+        return 0;
+    }
+    return static_cast<size_t>(value * scale);
+}
+
+std::string MemoryGovernor::formatSize(size_t bytes) {
+    char text[32];
+    if (bytes >= 1024 * 1024) {
+        std::snprintf(text, sizeof(text), "%.1fM", bytes / (1024.0 * 1024.0));
+    } else {
+        std::snprintf(text, sizeof(text), "%.1fK", bytes / 1024.0);
+    }
+    return text;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Accounts the player's large structures against a byte budget. When the
+// total is over budget, the lowest-priority consumers are asked to give
+// memory back first, the largest first among equals. A consumer that can
+// only stop growing (limit) gives its memory back over the next frames;
+// until the total stops falling nothing else is shrunk. When everything
+// has given what it can and the total is still over, nothing is shrunk
+// again until the total grows by an eighth of the budget, so caches that
+// refill are not cleared every frame. Consumers are measured and shrunk on
+// the thread that calls enforce(); the stats accessors may be used from any
+// thread.
+class MemoryGovernor {
+public:
+    struct Consumer {
+        std::string name;
+        int priority = 0;                          // lower gives memory back first
+        std::function<size_t()> usage;             // current bytes
+        std::function<size_t(size_t)> shrink;      // free about this many bytes now, return bytes freed
+        std::function<bool()> limit;               // hold less from now on; false if already at its floor
+        std::function<void()> relax;               // undo shrinking once there is room again
+    };
+
+    struct Entry {
+        std::string name;
+        size_t bytes = 0;
+    };
+
+    explicit MemoryGovernor(size_t budget = 0);
+
+    void setBudget(size_t bytes) { budget_bytes = bytes; }
+    size_t budget() const { return budget_bytes; }
+    bool enabled() const { return budget_bytes > 0; }
+
+    void add(Consumer consumer);
+    void clear();
+
+    // Measure everything and shrink consumers until back under budget.
+    // Cheap enough to call once per frame.
+    void enforce();
+
+    // Last measurement (after any shrinking), in registration order
+    std::vector<Entry> breakdown() const;
+    size_t usage() const;
+    // Shrink and limit steps taken
+    size_t shrinkCount() const;
+    // Highest total measured, before shrinking
+    size_t peak() const;
+
+    // Parses sizes like "1G", "512M", "64k" or plain bytes; 0 if invalid
+    static size_t parseSize(const std::string& text);
+    static std::string formatSize(size_t bytes);
+
+private:
+    size_t budget_bytes;
+    std::vector<Consumer> consumers;
+    bool settling = false;     // a limited consumer is still giving memory back
+    size_t settle_total = 0;   // total when last measured while settling
+    bool exhausted = false;    // over budget with nothing left to shrink
+    size_t exhausted_total = 0;
+
+    mutable std::mutex stats_mutex;
+    std::vector<Entry> last_breakdown;
+    size_t last_total = 0;
+    size_t peak_total = 0;
+    size_t shrink_events = 0;
+};
@@ -1,11 +1,13 @@
 #include "player_config.hpp"
+#include "memory_governor.hpp"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 
 PlayerConfig PlayerConfig::fromCommandLine(int argc, char* argv[]) {
     PlayerConfig config;
-    config.videoPath = argv[1];
     
-    for (int i = 2; i < argc; i++) {
+    for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--color" || arg == "-c") {
             config.colorMode = COLOR_8BIT;
@@ -19,11 +21,83 @@ PlayerConfig PlayerConfig::fromCommandLine(int argc, char* argv[]) {
             config.autoLoop = true;
         } else if (arg == "--block" || arg == "-b") {
             config.blockMode = true;
+        } else if (arg == "--autocrop" || arg == "-a") {
+            config.autoCrop = true;
+        } else if (arg == "--no-prompt") {
+            config.noPrompt = true;
+        } else if (arg == "--bench") {
+            config.benchMode = true;
+        } else if (arg == "--buffer-min") {
+            if (i + 1 < argc) config.bufferMin = static_cast<size_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--buffer-max") {
+            if (i + 1 < argc) config.bufferMax = static_cast<size_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--low-latency") {
+            // Interactive use: controls take effect within a few frames
+            config.bufferMin = 1;
+            config.bufferMax = 4;
+        } else if (arg == "--delta") {
+            config.deltaMode = true;
+        } else if (arg == "--wall-output") {
+            if (i + 1 < argc) config.wallOutputs.push_back(argv[++i]);
+        } else if (arg == "--wall-columns") {
+            if (i + 1 < argc) config.wallColumns = std::max(std::atoi(argv[++i]), 0);
+        } else if (arg == "--export") {
+            if (i + 1 < argc) config.exportPath = argv[++i];
+        } else if (arg == "--stream") {
+            if (i + 1 < argc) config.streamTarget = argv[++i];
+        } else if (arg == "--thumb-interval") {
+            if (i + 1 < argc) config.thumbnailInterval = std::max(std::atof(argv[++i]), 0.0);
+        } else if (arg == "--kitty") {
+            config.kitty = true;
+        } else if (arg == "--sixel") {
+            config.sixel = true;
+        } else if (arg == "--interlace") {
+            config.interlace = true;
+        } else if (arg == "--max-frame-bytes") {
+            // Budgeted updates only make sense against the previous screen
+            if (i + 1 < argc) {
+                config.maxFrameBytes = MemoryGovernor::parseSize(argv[++i]);
+                if (config.maxFrameBytes == 0) std::cerr << "Warning: invalid frame byte budget " << argv[i] << std::endl;
+                else config.deltaMode = true;
+            }
+        } else if (arg == "--memory-budget") {
+            if (i + 1 < argc) {
+                config.memoryBudget = MemoryGovernor::parseSize(argv[++i]);
+                if (config.memoryBudget == 0) std::cerr << "Warning: invalid memory budget " << argv[i] << std::endl;
+            }
+        } else if (arg == "--record-session") {
+            if (i + 1 < argc) config.recordSessionPath = argv[++i];
+        } else if (arg == "--replay-session") {
+            if (i + 1 < argc) config.replaySessionPath = argv[++i];
+        } else if (arg == "--playlist" || arg == "-p") {
+            if (i + 1 < argc) {
+                std::vector<std::string> items = loadPlaylist(argv[++i]);
+                config.playlist.insert(config.playlist.end(), items.begin(), items.end());
+            }
+        } else if (arg.empty() || arg[0] != '-') {
+            config.playlist.push_back(arg);
         }
     }
+    if (!config.playlist.empty()) config.videoPath = config.playlist.front();
     return config;
 }
 
+std::vector<std::string> PlayerConfig::loadPlaylist(const std::string& path) {
+    std::vector<std::string> items;
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Warning: cannot read playlist " << path << std::endl;
+        return items;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        items.push_back(line);
+    }
+    return items;
+}
+
 PlayerConfig PlayerConfig::fromInteractive() {
     PlayerConfig config;
     std::cout << "ASCII Video Player with Color Support\n"
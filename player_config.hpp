@@ -1,8 +1,10 @@
 #pragma once
 #include <string>
+#include <vector>
 
 struct PlayerConfig {
     std::string videoPath;
+    std::vector<std::string> playlist; // videoPath is always the first entry
     int width = 0;
     int height = 0;
     bool autoLoop = false;
@@ -13,11 +15,32 @@ struct PlayerConfig {
         COLOR_24BIT
     } colorMode = MONO;
     
+    bool autoCrop = false;   // detect and skip letterbox/pillarbox bars
+    bool noPrompt = false;   // start playback without waiting on the info screen
+    bool benchMode = false;  // decode and convert without drawing, then print timings
+    
+    std::string recordSessionPath;  // log keys, resizes and clock readings here
+    std::string replaySessionPath;  // play back such a log instead of the real input
+    size_t memoryBudget = 0;        // bytes for buffers and caches, 0 for no limit
+    bool deltaMode = false;         // redraw only the cells that changed
+    size_t maxFrameBytes = 0;       // per-frame output budget in delta mode, 0 for no limit
+    bool interlace = false;         // repaint alternate rows on alternate frames
+    bool sixel = false;             // sixel images instead of character cells
+    bool kitty = false;             // kitty graphics through shared memory
+    std::vector<std::string> wallOutputs;  // terminals that together show one picture
+    int wallColumns = 0;            // wall tiles per row, 0 for a single row
+    std::string exportPath;         // draw the frames into this video file instead
+    double thumbnailInterval = 10.0; // seconds between scrub preview thumbnails, 0 for none
+    std::string streamTarget;       // binary cell stream for remote viewers: unix:PATH, or a file or FIFO
+    
     double speedMultiplier = 1.0;
-    size_t bufferSize = 16;
+    size_t bufferMin = 4;    // frames decoded ahead, adapted between these bounds
+    size_t bufferMax = 16;
     
     // Command line parsing
     static PlayerConfig fromCommandLine(int argc, char* argv[]);
+    // One path per line; blank lines and lines starting with '#' are skipped
+    static std::vector<std::string> loadPlaylist(const std::string& path);
     // Interactive configuration
     static PlayerConfig fromInteractive();
 };
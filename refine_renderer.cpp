@@ -0,0 +1,259 @@
+#include "refine_renderer.hpp"
+#include <array>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+// Approximate ink coverage of glyphs with an obvious spatial structure,
+// per quadrant (top-left, top-right, bottom-left, bottom-right).
+struct GlyphShape {
+    char ch;
+    float q[4];
+};
+
+const GlyphShape SHAPED_GLYPHS[] = {
+    {'`',  {0.20f, 0.05f, 0.00f, 0.00f}},
+    {'\'', {0.12f, 0.12f, 0.00f, 0.00f}},
+    {'"',  {0.25f, 0.25f, 0.00f, 0.00f}},
+    {'.',  {0.00f, 0.00f, 0.12f, 0.12f}},
+    {',',  {0.00f, 0.00f, 0.18f, 0.18f}},
+    {'_',  {0.00f, 0.00f, 0.30f, 0.30f}},
+    {'/',  {0.00f, 0.40f, 0.40f, 0.00f}},
+    {'\\', {0.40f, 0.00f, 0.00f, 0.40f}},
+    {'L',  {0.30f, 0.00f, 0.55f, 0.35f}},
+    {'J',  {0.00f, 0.30f, 0.35f, 0.55f}},
+    {'7',  {0.45f, 0.55f, 0.00f, 0.30f}},
+    {'T',  {0.50f, 0.50f, 0.20f, 0.20f}},
+    {'P',  {0.65f, 0.55f, 0.30f, 0.00f}},
+    {'F',  {0.65f, 0.40f, 0.35f, 0.00f}},
+    {'b',  {0.35f, 0.00f, 0.65f, 0.55f}},
+    {'d',  {0.00f, 0.35f, 0.55f, 0.65f}},
+    {'p',  {0.55f, 0.55f, 0.40f, 0.00f}},
+    {'q',  {0.55f, 0.55f, 0.00f, 0.40f}},
+};
+
+struct Candidate {
+    char ch;
+    float q[4];
+    float mean;
+};
+
+std::vector<Candidate> buildCandidates(const std::string& charset) {
+    std::vector<Candidate> candidates;
+    // The plain ramp keeps flat areas identical in tone to the real-time path
+    size_t n = charset.size();
+    for (size_t i = 0; i < n; ++i) {
+        float d = n > 1 ? static_cast<float>(i) / (n - 1) : 0.0f;
+        candidates.push_back({charset[i], {d, d, d, d}, d});
+    }
+    for (const auto& g : SHAPED_GLYPHS) {
+        float m = (g.q[0] + g.q[1] + g.q[2] + g.q[3]) / 4.0f;
+        candidates.push_back({g.ch, {g.q[0], g.q[1], g.q[2], g.q[3]}, m});
+    }
+    return candidates;
+}
+
+const std::array<float, 256>& srgbToLinearTable() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table;
+}
+
+int linearToSrgb(float v) {
+    v = std::min(std::max(v, 0.0f), 1.0f);
+    float s = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+    return static_cast<int>(std::lround(s * 255.0f));
+}
+
+const int CUBE_LEVELS[6] = {0, 95, 135, 175, 215, 255};
+
+int nearestCubeIndex(int v) {
+    int best = 0;
+    for (int i = 1; i < 6; ++i) {
+        if (std::abs(CUBE_LEVELS[i] - v) < std::abs(CUBE_LEVELS[best] - v)) best = i;
+    }
+    return best;
+}
+
+// Nearest xterm-256 entry by squared RGB distance; writes back the palette
+// color so the caller can diffuse the quantization error.
+int nearest8BitColor(int r, int g, int b, int& pr, int& pg, int& pb) {
+    int ir = nearestCubeIndex(r), ig = nearestCubeIndex(g), ib = nearestCubeIndex(b);
+    int cr = CUBE_LEVELS[ir], cg = CUBE_LEVELS[ig], cb = CUBE_LEVELS[ib];
+    int cube_dist = (cr - r) * (cr - r) + (cg - g) * (cg - g) + (cb - b) * (cb - b);
+
+    int k = std::min(std::max(static_cast<int>(std::lround(((r + g + b) / 3.0 - 8) / 10.0)), 0), 23);
+    int gv = 8 + 10 * k;
+    int gray_dist = (gv - r) * (gv - r) + (gv - g) * (gv - g) + (gv - b) * (gv - b);
+
+    if (gray_dist < cube_dist) {
+        pr = pg = pb = gv;
+        return 232 + k;
+    }
+    pr = cr; pg = cg; pb = cb;
+    return 16 + 36 * ir + 6 * ig + ib;
+}
+
+// Floyd-Steinberg over a row-major grid of `channels` floats per cell
+void diffuseError(std::vector<float>& grid, int w, int h, int channels, int x, int y, const float* err) {
+    auto add = [&](int nx, int ny, float weight) {
+        if (nx < 0 || nx >= w || ny >= h) return;
+        float* cell = &grid[(static_cast<size_t>(ny) * w + nx) * channels];
+        for (int c = 0; c < channels; ++c) cell[c] += err[c] * weight;
+    };
+    add(x + 1, y,     7.0f / 16.0f);
+    add(x - 1, y + 1, 3.0f / 16.0f);
+    add(x,     y + 1, 5.0f / 16.0f);
+    add(x + 1, y + 1, 1.0f / 16.0f);
+}
+
+} // namespace
+
+void glyphCoverage(char ch, const std::string& charset, float q[4]) {
+    for (const auto& g : SHAPED_GLYPHS) {
+        if (g.ch == ch) {
+            std::copy(g.q, g.q + 4, q);
+            return;
+        }
+    }
+    size_t pos = charset.find(ch);
+    float d = (pos != std::string::npos && charset.size() > 1) ? static_cast<float>(pos) / (charset.size() - 1) : 0.0f;
+    std::fill(q, q + 4, d);
+}
+
+size_t refineScratchBytes(int frame_width, int frame_height, const RefineParams& params) {
+    size_t cells = static_cast<size_t>(std::max(params.grid_width, 0)) * std::max(params.grid_height, 0);
+    size_t linear = static_cast<size_t>(std::max(frame_width, 0)) * std::max(frame_height, 0) * 3 * sizeof(float);
+    // 2x2 float samples and their luma, quadrants, colors and tone error per cell, ~20 output bytes per cell
+    return linear + cells * (4 * 3 * sizeof(float) + 4 + (4 + 3 + 1) * sizeof(float) + 20);
+}
+
+std::string refineFrame(const cv::Mat& frame, const RefineParams& params, const std::atomic<bool>& cancel) {
+    const int cols = params.grid_width;
+    const int rows = params.grid_height;
+    if (frame.empty() || cols <= 0 || rows <= 0 || params.charset.empty()) return "";
+
+    // Linear-light resample to 2x2 samples per cell
+    const auto& to_linear = srgbToLinearTable();
+    cv::Mat linear(frame.rows, frame.cols, CV_32FC3);
+    for (int y = 0; y < frame.rows; ++y) {
+        if (cancel) return "";
+        const cv::Vec3b* src = frame.ptr<cv::Vec3b>(y);
+        cv::Vec3f* dst = linear.ptr<cv::Vec3f>(y);
+        for (int x = 0; x < frame.cols; ++x) {
+            dst[x] = cv::Vec3f(to_linear[src[x][0]], to_linear[src[x][1]], to_linear[src[x][2]]);
+        }
+    }
+    cv::Mat samples;
+    cv::resize(linear, samples, cv::Size(cols * 2, rows * 2), 0, 0, cv::INTER_AREA);
+    if (cancel) return "";
+
+    // Per-sample perceptual luminance, matching the real-time brightness weights
+    cv::Mat luma(samples.rows, samples.cols, CV_8UC1);
+    for (int y = 0; y < samples.rows; ++y) {
+        const cv::Vec3f* src = samples.ptr<cv::Vec3f>(y);
+        uint8_t* dst = luma.ptr<uint8_t>(y);
+        for (int x = 0; x < samples.cols; ++x) {
+            int b = linearToSrgb(src[x][0]), g = linearToSrgb(src[x][1]), r = linearToSrgb(src[x][2]);
+            dst[x] = static_cast<uint8_t>(0.299 * r + 0.587 * g + 0.114 * b);
+        }
+    }
+    if (params.color_mode == 0) cv::equalizeHist(luma, luma);
+    if (cancel) return "";
+
+    // Cell targets: 4 quadrant luminances, then average linear color (BGR)
+    std::vector<float> quads(static_cast<size_t>(cols) * rows * 4);
+    std::vector<float> colors(static_cast<size_t>(cols) * rows * 3);
+    for (int cy = 0; cy < rows; ++cy) {
+        const uint8_t* l0 = luma.ptr<uint8_t>(cy * 2);
+        const uint8_t* l1 = luma.ptr<uint8_t>(cy * 2 + 1);
+        const cv::Vec3f* s0 = samples.ptr<cv::Vec3f>(cy * 2);
+        const cv::Vec3f* s1 = samples.ptr<cv::Vec3f>(cy * 2 + 1);
+        for (int cx = 0; cx < cols; ++cx) {
+            float* q = &quads[(static_cast<size_t>(cy) * cols + cx) * 4];
+            q[0] = l0[cx * 2] / 255.0f;
+            q[1] = l0[cx * 2 + 1] / 255.0f;
+            q[2] = l1[cx * 2] / 255.0f;
+            q[3] = l1[cx * 2 + 1] / 255.0f;
+            float* c = &colors[(static_cast<size_t>(cy) * cols + cx) * 3];
+            for (int ch = 0; ch < 3; ++ch) {
+                float avg = (s0[cx * 2][ch] + s0[cx * 2 + 1][ch] + s1[cx * 2][ch] + s1[cx * 2 + 1][ch]) / 4.0f;
+                c[ch] = static_cast<float>(linearToSrgb(avg));
+            }
+        }
+    }
+
+    const std::vector<Candidate> candidates = buildCandidates(params.charset);
+    std::vector<float> tone_error(static_cast<size_t>(cols) * rows, 0.0f);
+
+    std::string out;
+    out.reserve(static_cast<size_t>(cols) * rows * 20 + rows);
+
+    for (int cy = 0; cy < rows; ++cy) {
+        if (cancel) return "";
+        std::string last_code;
+        for (int cx = 0; cx < cols; ++cx) {
+            size_t idx = static_cast<size_t>(cy) * cols + cx;
+            float* c = &colors[idx * 3];
+
+            if (params.color_mode != 0) {
+                int r = std::min(std::max(static_cast<int>(std::lround(c[2])), 0), 255);
+                int g = std::min(std::max(static_cast<int>(std::lround(c[1])), 0), 255);
+                int b = std::min(std::max(static_cast<int>(std::lround(c[0])), 0), 255);
+                std::string code;
+                const char* layer = params.block_mode ? "48" : "38";
+                if (params.color_mode == 1) {
+                    int pr, pg, pb;
+                    int color = nearest8BitColor(r, g, b, pr, pg, pb);
+                    float err[3] = {c[0] - pb, c[1] - pg, c[2] - pr};
+                    diffuseError(colors, cols, rows, 3, cx, cy, err);
+                    code = std::string("\033[") + layer + ";5;" + std::to_string(color) + "m";
+                } else {
+                    code = std::string("\033[") + layer + ";2;" + std::to_string(r) + ";" +
+                           std::to_string(g) + ";" + std::to_string(b) + "m";
+                }
+                if (code != last_code) {
+                    out += code;
+                    last_code = code;
+                }
+            }
+
+            if (params.block_mode && params.color_mode != 0) {
+                out += ' ';
+                continue;
+            }
+
+            // Shape match against the error-adjusted quadrant targets
+            const float* q = &quads[idx * 4];
+            float e = tone_error[idx];
+            float t[4] = {q[0] + e, q[1] + e, q[2] + e, q[3] + e};
+            const Candidate* best = &candidates[0];
+            float best_cost = 1e30f;
+            for (const auto& cand : candidates) {
+                float cost = 0.0f;
+                for (int i = 0; i < 4; ++i) {
+                    float d = t[i] - cand.q[i];
+                    cost += d * d;
+                }
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best = &cand;
+                }
+            }
+            float err = (t[0] + t[1] + t[2] + t[3]) / 4.0f - best->mean;
+            diffuseError(tone_error, cols, rows, 1, cx, cy, &err);
+            out += best->ch;
+        }
+        if (params.color_mode != 0) out += "\033[0m";
+        out += '\n';
+    }
+    return out;
+}
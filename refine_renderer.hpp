@@ -0,0 +1,28 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <string>
+
+// Parameters for the high-quality (slow) renderer. The grid size is the
+// final cell grid, so the result lines up exactly with the real-time frame
+// it replaces.
+struct RefineParams {
+    int grid_width = 0;
+    int grid_height = 0;
+    int color_mode = 0;      // 0 = mono, 1 = 8-bit, 2 = 24-bit
+    bool block_mode = false;
+    std::string charset;     // brightness ramp, darkest first
+};
+
+// Renders `frame` with linear-light resampling, glyph shape matching and
+// error-diffusion dithering. Polls `cancel` between rows and returns an
+// empty string as soon as it is set.
+std::string refineFrame(const cv::Mat& frame, const RefineParams& params, const std::atomic<bool>& cancel);
+
+// Working memory refineFrame allocates for a frame of this size, output included
+size_t refineScratchBytes(int frame_width, int frame_height, const RefineParams& params);
+
+// Ink coverage per quadrant (top-left, top-right, bottom-left, bottom-right)
+// that the glyph matcher assumes for `ch`: its shape if it has one, else its
+// position in the ramp. Characters outside both are treated as blank.
+void glyphCoverage(char ch, const std::string& charset, float q[4]);
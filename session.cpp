@@ -0,0 +1,230 @@
+#include "session.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// Log format, one event per line (times in ms since start()):
+//   S <cols> <rows>             terminal size when recording started
+//   T <frame> <ms>              clock reading, after <frame> frames were shown
+//   K <frame> <ms> <code>       key press
+//   W <frame> <ms> <cols> <rows> window size change
+
+namespace {
+
+const char SESSION_HEADER[] = "# terminal_video session 1";
+
+using Clock = std::chrono::steady_clock;
+
+std::atomic<bool> resize_pending{false};
+
+void resizeHandler(int) {
+    resize_pending = true;
+}
+
+bool readTerminalSize(int& cols, int& rows) {
+    struct winsize w;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) != 0 || w.ws_col == 0) return false;
+    cols = w.ws_col;
+    rows = w.ws_row;
+    return true;
+}
+
+bool readKey(char& key) {
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    return poll(&pfd, 1, 0) > 0 && read(STDIN_FILENO, &key, 1) == 1;
+}
+
+class LiveSession : public Session {
+public:
+    explicit LiveSession(const std::string& record_path) {
+        int cols, rows;
+        if (readTerminalSize(cols, rows)) {
+            term_cols = cols;
+            term_rows = rows;
+        }
+        struct sigaction action = {};
+        action.sa_handler = resizeHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGWINCH, &action, nullptr);
+
+        if (!record_path.empty()) {
+            log.open(record_path);
+            if (!log) {
+                std::cerr << "Warning: cannot write session log " << record_path << std::endl;
+            } else {
+                log << SESSION_HEADER << "\n" << "S " << term_cols << " " << term_rows << "\n"
+                    << std::fixed << std::setprecision(3);
+            }
+        }
+        started = Clock::now();
+    }
+
+    void start() override {
+        started = Clock::now();
+    }
+
+    double now() override {
+        double t = elapsed();
+        if (log) log << "T " << frames_shown << " " << t << "\n";
+        return t;
+    }
+
+    bool poll(SessionEvent& event) override {
+        if (resize_pending.exchange(false)) {
+            int cols, rows;
+            if (readTerminalSize(cols, rows)) {
+                term_cols = cols;
+                term_rows = rows;
+                event.type = SessionEvent::RESIZE;
+                event.cols = cols;
+                event.rows = rows;
+                if (log) log << "W " << frames_shown << " " << elapsed() << " " << cols << " " << rows << "\n";
+                return true;
+            }
+        }
+        char key;
+        if (!readKey(key)) return false;
+        event.type = SessionEvent::KEY;
+        event.key = key;
+        if (log) log << "K " << frames_shown << " " << elapsed() << " " << static_cast<int>(key) << "\n";
+        return true;
+    }
+
+private:
+    double elapsed() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    }
+
+    std::ofstream log;
+    Clock::time_point started;
+};
+
+class ReplaySession : public Session {
+public:
+    struct Entry {
+        char type;
+        long frame;
+        double ms;
+        int a, b;
+    };
+
+    explicit ReplaySession(std::vector<Entry> entries) : entries(std::move(entries)) {}
+
+    void setInitialSize(int cols, int rows) {
+        term_cols = cols;
+        term_rows = rows;
+    }
+
+    void start() override {
+        anchor_real = Clock::now();
+        anchor_ms = 0.0;
+    }
+
+    // The recorded reading when the loop is where it was when recording,
+    // otherwise real time elapsed since the last one that matched
+    double now() override {
+        skipStaleReadings();
+        if (next < entries.size() && entries[next].type == 'T' && entries[next].frame == frames_shown) {
+            anchor_ms = entries[next++].ms;
+            anchor_real = Clock::now();
+            after_reading = true;
+            return anchor_ms;
+        }
+        return extrapolated();
+    }
+
+    bool poll(SessionEvent& event) override {
+        // Only quitting is taken from the real keyboard
+        char key;
+        if (readKey(key) && (key == 'q' || key == 'Q' || key == 27)) {
+            event.type = SessionEvent::KEY;
+            event.key = key;
+            return true;
+        }
+
+        skipStaleReadings();
+        if (next >= entries.size()) return false;
+        const Entry& e = entries[next];
+        if (e.type == 'T' || e.frame > frames_shown) return false;
+        // Right after a matching reading the loop is where it polled this
+        // event when recording; otherwise (e.g. paused) wait for its time
+        if (e.frame == frames_shown && !after_reading && extrapolated() < e.ms) return false;
+        next++;
+        after_reading = false;
+        if (e.type == 'K') {
+            event.type = SessionEvent::KEY;
+            event.key = static_cast<char>(e.a);
+        } else {
+            event.type = SessionEvent::RESIZE;
+            event.cols = e.a;
+            event.rows = e.b;
+            term_cols = e.a;
+            term_rows = e.b;
+        }
+        return true;
+    }
+
+private:
+    double extrapolated() const {
+        return anchor_ms + std::chrono::duration<double, std::milli>(Clock::now() - anchor_real).count();
+    }
+
+    // Readings from frames the replay has already passed
+    void skipStaleReadings() {
+        while (next < entries.size() && entries[next].type == 'T' && entries[next].frame < frames_shown) next++;
+    }
+
+    std::vector<Entry> entries;
+    size_t next = 0;
+    bool after_reading = false;
+    double anchor_ms = 0.0;
+    Clock::time_point anchor_real = Clock::now();
+};
+
+} // namespace
+
+std::unique_ptr<Session> Session::live(const std::string& record_path) {
+    return std::make_unique<LiveSession>(record_path);
+}
+
+std::unique_ptr<Session> Session::replay(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != SESSION_HEADER) {
+        std::cerr << "Error: " << path << " is not a session log" << std::endl;
+        return nullptr;
+    }
+
+    std::vector<ReplaySession::Entry> entries;
+    int cols = 80, rows = 24;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        ReplaySession::Entry e = {0, 0, 0.0, 0, 0};
+        if (!(in >> e.type)) continue;
+        bool ok = true;
+        switch (e.type) {
+            case 'S': ok = static_cast<bool>(in >> cols >> rows); break;
+            case 'T': ok = static_cast<bool>(in >> e.frame >> e.ms); break;
+            case 'K': ok = static_cast<bool>(in >> e.frame >> e.ms >> e.a); break;
+            case 'W': ok = static_cast<bool>(in >> e.frame >> e.ms >> e.a >> e.b); break;
+            default: ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Error: bad line in session log " << path << ": " << line << std::endl;
+            return nullptr;
+        }
+        if (e.type != 'S') entries.push_back(e);
+    }
+
+    auto session = std::make_unique<ReplaySession>(std::move(entries));
+    session->setInitialSize(cols, rows);
+    return session;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+
+struct SessionEvent {
+    enum Type { KEY, RESIZE } type = KEY;
+    char key = 0;
+    int cols = 0;   // new terminal size for RESIZE
+    int rows = 0;
+};
+
+// Clock, keyboard and terminal size for the playback loop. A live session
+// reads the real ones (and can log them); a replay feeds a log back, so the
+// same keys land on the same frames with the same clock readings.
+class Session {
+public:
+    virtual ~Session() = default;
+
+    // Restart the clock when playback begins
+    virtual void start() = 0;
+    // Milliseconds since start()
+    virtual double now() = 0;
+    // Next key press or window size change that is due, if any
+    virtual bool poll(SessionEvent& event) = 0;
+
+    // Called by the playback loop after each frame is put on screen
+    void frameShown() { frames_shown++; }
+
+    // Safe to call from any thread
+    int terminalWidth() const { return term_cols; }
+    int terminalHeight() const { return term_rows; }
+
+    // Real terminal; logs to `record_path` unless it is empty
+    static std::unique_ptr<Session> live(const std::string& record_path);
+    // Replays a recorded log, or nullptr if it cannot be read
+    static std::unique_ptr<Session> replay(const std::string& path);
+
+protected:
+    long frames_shown = 0;
+    std::atomic<int> term_cols{80};
+    std::atomic<int> term_rows{24};
+};
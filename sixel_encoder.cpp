@@ -0,0 +1,213 @@
+#include "sixel_encoder.hpp"
+#include <algorithm>
+
+namespace {
+
+// Color cube levels per channel; green gets one more, the eye resolves it best
+const int R_LEVELS = 6;
+const int G_LEVELS = 7;
+const int B_LEVELS = 6;
+const int COLOR_COUNT = R_LEVELS * G_LEVELS * B_LEVELS;  // 252 registers
+const int GRAY_COUNT = 64;
+const int MAX_PALETTE = 256;
+const int BAND_HEIGHT = 6;
+
+int nearestLevel(int value, int levels) {
+    return (value * (levels - 1) + 127) / 255;
+}
+
+// Palette index for every color at 5 bits per channel, built once
+const uint8_t* colorTable() {
+    static const std::vector<uint8_t> table = []() {
+        std::vector<uint8_t> t(32 * 32 * 32);
+        for (int r = 0; r < 32; ++r) {
+            for (int g = 0; g < 32; ++g) {
+                for (int b = 0; b < 32; ++b) {
+                    // Centre of the 8-value bucket
+                    int ri = nearestLevel(r * 8 + 4, R_LEVELS);
+                    int gi = nearestLevel(g * 8 + 4, G_LEVELS);
+                    int bi = nearestLevel(b * 8 + 4, B_LEVELS);
+                    t[(r << 10) | (g << 5) | b] = static_cast<uint8_t>((ri * G_LEVELS + gi) * B_LEVELS + bi);
+                }
+            }
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+void appendNumber(std::string& out, int value) {
+    char digits[12];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) out += digits[--n];
+}
+
+// Register definition in RGB percentages
+void appendColorRegister(std::string& out, int index, bool grayscale) {
+    int r, g, b;
+    if (grayscale) {
+        r = g = b = index * 100 / (GRAY_COUNT - 1);
+    } else {
+        r = (index / (G_LEVELS * B_LEVELS)) * 100 / (R_LEVELS - 1);
+        g = ((index / B_LEVELS) % G_LEVELS) * 100 / (G_LEVELS - 1);
+        b = (index % B_LEVELS) * 100 / (B_LEVELS - 1);
+    }
+    out += '#';
+    appendNumber(out, index);
+    out += ";2;";
+    appendNumber(out, r);
+    out += ';';
+    appendNumber(out, g);
+    out += ';';
+    appendNumber(out, b);
+}
+
+void appendRun(std::string& out, char ch, int count) {
+    if (count > 3) {
+        out += '!';
+        appendNumber(out, count);
+        out += ch;
+    } else {
+        out.append(static_cast<size_t>(count), ch);
+    }
+}
+
+} // namespace
+
+cv::Size SixelEncoder::imageSize(int src_width, int src_height, int max_width, int max_height) {
+    if (max_width <= 0 || max_height <= 0) {
+        max_width = DEFAULT_WIDTH;
+        max_height = DEFAULT_HEIGHT;
+    }
+    if (src_width <= 0 || src_height <= 0) return cv::Size(0, 0);
+    double scale = std::min(static_cast<double>(max_width) / src_width, static_cast<double>(max_height) / src_height);
+    return cv::Size(std::max(1, static_cast<int>(src_width * scale)), std::max(1, static_cast<int>(src_height * scale)));
+}
+
+std::string SixelEncoder::encode(const cv::Mat& frame, const SixelParams& params) {
+    std::string out;
+    encode(frame, params, out);
+    return out;
+}
+
+void SixelEncoder::encode(const cv::Mat& frame, const SixelParams& params, std::string& out) {
+    out.clear();
+    if (frame.empty()) return;
+    cv::Size size = imageSize(frame.cols, frame.rows, params.width, params.height);
+    cv::resize(frame, resized, size, 0, 0, cv::INTER_AREA);
+
+    int band_count = (size.height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    if (static_cast<int>(bands.size()) < band_count) bands.resize(band_count);
+    cv::parallel_for_(cv::Range(0, band_count), [&](const cv::Range& range) {
+        for (int band = range.start; band < range.end; ++band) encodeBand(band, params.grayscale);
+    });
+
+    // Define only the registers some band uses
+    bool used[MAX_PALETTE] = {false};
+    size_t body = 0;
+    for (int band = 0; band < band_count; ++band) {
+        for (uint8_t c : bands[band].colors) used[c] = true;
+        body += bands[band].data.size();
+    }
+    out.reserve(body + 64 + 20 * MAX_PALETTE);
+    // P2=1: pixels left at 0 keep what is on screen; raster attributes give the size
+    out += "\033P0;1;0q\"1;1;";
+    appendNumber(out, size.width);
+    out += ';';
+    appendNumber(out, size.height);
+    for (int c = 0; c < MAX_PALETTE; ++c) {
+        if (used[c]) appendColorRegister(out, c, params.grayscale);
+    }
+    for (int band = 0; band < band_count; ++band) {
+        out += bands[band].data;
+        if (band + 1 < band_count) out += '-';
+    }
+    out += "\033\\";
+}
+
+void SixelEncoder::encodeBand(int band_index, bool grayscale) {
+    Band& band = bands[band_index];
+    const int width = resized.cols;
+    const int y0 = band_index * BAND_HEIGHT;
+    const int rows = std::min(BAND_HEIGHT, resized.rows - y0);
+    const uint8_t* table = colorTable();
+
+    // Palette index per pixel through the lookup table
+    band.index.resize(static_cast<size_t>(rows) * width);
+    for (int k = 0; k < rows; ++k) {
+        const cv::Vec3b* src = resized.ptr<cv::Vec3b>(y0 + k);
+        uint8_t* dst = &band.index[static_cast<size_t>(k) * width];
+        for (int x = 0; x < width; ++x) {
+            int b = src[x][0], g = src[x][1], r = src[x][2];
+            dst[x] = grayscale ? static_cast<uint8_t>(((77 * r + 150 * g + 29 * b) >> 8) >> 2)
+                               : table[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
+        }
+    }
+
+    // Sixel bits per color in one pass; colors get rows of `bits` as they appear
+    band.slot.assign(grayscale ? GRAY_COUNT : COLOR_COUNT, -1);
+    band.colors.clear();
+    band.first.clear();
+    band.last.clear();
+    band.bits.clear();
+    for (int k = 0; k < rows; ++k) {
+        const uint8_t* idx = &band.index[static_cast<size_t>(k) * width];
+        for (int x = 0; x < width; ++x) {
+            int c = idx[x];
+            int s = band.slot[c];
+            if (s < 0) {
+                s = static_cast<int>(band.colors.size());
+                band.slot[c] = s;
+                band.colors.push_back(static_cast<uint8_t>(c));
+                band.first.push_back(x);
+                band.last.push_back(x);
+                band.bits.resize(band.bits.size() + width, 0);
+            }
+            band.bits[static_cast<size_t>(s) * width + x] |= static_cast<uint8_t>(1 << k);
+            band.first[s] = std::min(band.first[s], x);
+            band.last[s] = std::max(band.last[s], x);
+        }
+    }
+
+    // One pass per color, back to the band's left edge ('$') between colors
+    band.data.clear();
+    for (size_t s = 0; s < band.colors.size(); ++s) {
+        if (s > 0) band.data += '$';
+        band.data += '#';
+        appendNumber(band.data, band.colors[s]);
+        const uint8_t* bits = &band.bits[s * width];
+        if (band.first[s] > 0) appendRun(band.data, '?', band.first[s]);
+        char run_char = 0;
+        int run = 0;
+        for (int x = band.first[s]; x <= band.last[s]; ++x) {
+            char ch = static_cast<char>('?' + bits[x]);
+            if (ch == run_char) {
+                run++;
+                continue;
+            }
+            if (run > 0) appendRun(band.data, run_char, run);
+            run_char = ch;
+            run = 1;
+        }
+        if (run > 0) appendRun(band.data, run_char, run);
+    }
+}
+
+void SixelEncoder::clearCaches() {
+    resized.release();
+    std::vector<Band>().swap(bands);
+}
+
+size_t SixelEncoder::memoryUsage() const {
+    size_t bytes = resized.total() * resized.elemSize();
+    for (const auto& band : bands) {
+        bytes += band.data.capacity() + band.index.capacity() + band.bits.capacity() +
+                 band.slot.capacity() * sizeof(int) + band.colors.capacity() +
+                 (band.first.capacity() + band.last.capacity()) * sizeof(int);
+    }
+    return bytes;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SixelParams {
+    int width = 0;            // image size in pixels; 0 falls back to 640x360
+    int height = 0;
+    bool grayscale = false;   // 64 gray levels instead of the color palette
+};
+
+// Encodes BGR frames as DEC sixel images. Colors come from a fixed palette
+// (a 6x7x6 color cube, or 64 grays) through a lookup table built once, so
+// no per-frame quantization pass is needed; only the registers a frame uses
+// are defined in its header. Six-pixel bands are encoded in parallel.
+// Like AsciiRenderer, use one encoder per thread and reuse it across frames.
+class SixelEncoder {
+public:
+    static const int DEFAULT_WIDTH = 640;
+    static const int DEFAULT_HEIGHT = 360;
+
+    // Largest image of the source's aspect ratio that fits the given box
+    static cv::Size imageSize(int src_width, int src_height, int max_width, int max_height);
+
+    // Replaces `out` with one complete sixel sequence (DCS ... ST) for the
+    // frame scaled to the params' size. The image starts at the cursor.
+    void encode(const cv::Mat& frame, const SixelParams& params, std::string& out);
+    std::string encode(const cv::Mat& frame, const SixelParams& params);
+
+    // Approximate heap bytes held by scratch buffers
+    size_t memoryUsage() const;
+    // Releases the scratch buffers; the next frame allocates them again
+    void clearCaches();
+
+private:
+    struct Band {
+        std::string data;
+        std::vector<uint8_t> index;     // palette index per pixel of the band
+        std::vector<uint8_t> bits;      // sixel bits per used color and column
+        std::vector<int> slot;          // palette index -> row in `bits`, or -1
+        std::vector<uint8_t> colors;    // palette indices used, in first-seen order
+        std::vector<int> first, last;   // columns spanned per used color
+    };
+
+    void encodeBand(int band, bool grayscale);
+
+    cv::Mat resized;
+    std::vector<Band> bands;
+};
@@ -0,0 +1,142 @@
+#include "stream_output.hpp"
+#include "cell_stream.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool StreamOutput::open(const std::string& target) {
+    close();
+    std::string header;
+    CellStreamEncoder::appendHeader(header);
+
+    const std::string prefix = "unix:";
+    if (target.compare(0, prefix.size(), prefix) != 0) {
+        int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            std::cerr << "Error: cannot open stream output " << target << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        viewer_fds.push_back(fd);
+        viewers_seen = 1;
+        if (!writeAll(fd, header.data(), header.size(), false)) {
+            close();
+            return false;
+        }
+        bytes_sent += header.size();
+        return true;
+    }
+
+    socket_path = target.substr(prefix.size());
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: bad socket path " << socket_path << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(socket_path.c_str());  // left over from an earlier run
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, 8) != 0) {
+        std::cerr << "Error: cannot listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    return accept(true);
+}
+
+void StreamOutput::close() {
+    for (int fd : viewer_fds) {
+        ::close(fd);
+    }
+    viewer_fds.clear();
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+    listen_fd = -1;
+}
+
+bool StreamOutput::accept(bool wait) {
+    bool accepted = false;
+    while (true) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return accepted;
+        }
+        // Requests are read without blocking; frames are written with a timeout
+        timeval timeout = {SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        std::string header;
+        CellStreamEncoder::appendHeader(header);
+        if (!writeAll(fd, header.data(), header.size(), true)) {
+            ::close(fd);
+            continue;
+        }
+        bytes_sent += header.size();
+        viewer_fds.push_back(fd);
+        viewers_seen++;
+        accepted = true;
+        if (wait) {
+            // The listening socket only blocks for the first viewer
+            fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+            wait = false;
+        }
+    }
+}
+
+bool StreamOutput::poll() {
+    if (listen_fd < 0) return false;
+    bool keyframe = accept(false);
+    for (size_t i = 0; i < viewer_fds.size();) {
+        char requests[64];
+        ssize_t n = recv(viewer_fds[i], requests, sizeof(requests), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            // Viewer went away
+            ::close(viewer_fds[i]);
+            viewer_fds.erase(viewer_fds.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        if (n > 0 && std::find(requests, requests + n, static_cast<char>(cellstream::KEYFRAME_REQUEST)) != requests + n) {
+            keyframe = true;
+        }
+        ++i;
+    }
+    return keyframe;
+}
+
+bool StreamOutput::writeAll(int fd, const char* data, size_t size, bool socket) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = socket ? ::send(fd, data + done, size - done, MSG_NOSIGNAL) : ::write(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool StreamOutput::send(const std::string& message) {
+    for (size_t i = 0; i < viewer_fds.size();) {
+        if (writeAll(viewer_fds[i], message.data(), message.size(), listen_fd >= 0)) {
+            bytes_sent += message.size();
+            ++i;
+            continue;
+        }
+        if (listen_fd < 0) {
+            std::cerr << "Error: stream output failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        // Too slow or gone; it can reconnect and start from a keyframe
+        ::close(viewer_fds[i]);
+        viewer_fds.erase(viewer_fds.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    return listen_fd >= 0 || !viewer_fds.empty();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Where the player sends its cell stream (see cell_stream.hpp).
+// "unix:PATH" listens on a socket any number of viewers connect to: each
+// one gets the stream header right away and a keyframe next, and may ask
+// for another keyframe at any time. Anything else is a file or FIFO opened
+// for writing (not stdout, which shows the player's status). Like opening
+// a FIFO, opening a socket waits for the first viewer. Writes block; a
+// viewer that can't take a frame within a second is dropped, and a failed
+// file write ends the stream.
+class StreamOutput {
+public:
+    StreamOutput() = default;
+    ~StreamOutput() { close(); }
+    StreamOutput(const StreamOutput&) = delete;
+    StreamOutput& operator=(const StreamOutput&) = delete;
+
+    bool open(const std::string& target);
+    void close();
+
+    // Accepts new viewers and reads their requests; true if the next
+    // message should be a keyframe
+    bool poll();
+    // One message to every viewer; false once nobody can receive it
+    bool send(const std::string& message);
+
+    bool isSocket() const { return listen_fd >= 0; }
+    size_t viewers() const { return viewer_fds.size(); }
+    size_t viewersSeen() const { return viewers_seen; }
+    size_t bytesSent() const { return bytes_sent; }
+
+private:
+    static const int SEND_TIMEOUT_MS = 1000;
+
+    bool accept(bool wait);
+    static bool writeAll(int fd, const char* data, size_t size, bool socket);
+
+    int listen_fd = -1;
+    std::string socket_path;
+    std::vector<int> viewer_fds;   // sockets, or the one file descriptor
+    size_t viewers_seen = 0;
+    size_t bytes_sent = 0;
+};
@@ -0,0 +1,58 @@
+/* C interface to the terminal_video renderer. */
+#ifndef TERMINAL_VIDEO_H
+#define TERMINAL_VIDEO_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tv_renderer tv_renderer;
+
+typedef enum {
+    TV_COLOR_MONO = 0,
+    TV_COLOR_8BIT = 1,
+    TV_COLOR_24BIT = 2
+} tv_color_mode;
+
+typedef struct {
+    int width;              /* target grid; 0 uses 120x40 */
+    int height;
+    tv_color_mode color_mode;
+    int block_mode;         /* non-zero: background-colored cells */
+} tv_render_params;
+
+/* Packed 8-bit BGR pixels owned by the caller */
+typedef struct {
+    const unsigned char* data;
+    int width;
+    int height;
+    size_t stride;          /* bytes per row, 0 for tightly packed rows */
+} tv_frame;
+
+/* A renderer keeps caches between frames; use one per thread.
+   Returns NULL if it cannot be created. */
+tv_renderer* tv_renderer_create(void);
+void tv_renderer_destroy(tv_renderer* renderer);
+
+/* Output capacity that is always enough for one frame of this size; 0 on error */
+size_t tv_max_output_size(const tv_render_params* params, int width, int height);
+
+/* Returns bytes written to `out`, or 0 on error or insufficient capacity */
+size_t tv_render(tv_renderer* renderer, const tv_frame* frame, const tv_render_params* params,
+                 char* out, size_t capacity);
+
+/* Frames are written back to back; lengths[i] (if `lengths` is not NULL)
+   receives the size of frame i. Empty frames (NULL data, or no pixels) are
+   skipped and get a length of 0. Returns the total bytes written, or 0 if
+   the frames do not fit in `capacity` or an error occurs; `out` and
+   `lengths` may then hold a partial batch. */
+size_t tv_render_batch(tv_renderer* renderer, const tv_frame* frames, size_t count,
+                       const tv_render_params* params, char* out, size_t capacity, size_t* lengths);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TERMINAL_VIDEO_H */
@@ -0,0 +1,80 @@
+#include "terminal_video.h"
+#include "ascii_renderer.hpp"
+#include <new>
+#include <vector>
+
+struct tv_renderer {
+    AsciiRenderer renderer;
+};
+
+namespace {
+
+RenderParams toRenderParams(const tv_render_params* params) {
+    RenderParams result;
+    if (!params) return result;
+    result.width = params->width;
+    result.height = params->height;
+    result.block_mode = params->block_mode != 0;
+    switch (params->color_mode) {
+        case TV_COLOR_8BIT: result.color_mode = RenderParams::COLOR_8BIT; break;
+        case TV_COLOR_24BIT: result.color_mode = RenderParams::COLOR_24BIT; break;
+        default: result.color_mode = RenderParams::MONO;
+    }
+    return result;
+}
+
+PixelBuffer toPixelBuffer(const tv_frame& frame) {
+    PixelBuffer buffer;
+    buffer.data = frame.data;
+    buffer.width = frame.width;
+    buffer.height = frame.height;
+    buffer.stride = frame.stride;
+    return buffer;
+}
+
+} // namespace
+
+// Exceptions must not cross the C boundary; failures are reported as NULL/0
+
+tv_renderer* tv_renderer_create(void) {
+    // nothrow covers the allocation only; the renderer's constructor allocates too
+    try {
+        return new (std::nothrow) tv_renderer();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void tv_renderer_destroy(tv_renderer* renderer) {
+    delete renderer;
+}
+
+size_t tv_max_output_size(const tv_render_params* params, int width, int height) {
+    try {
+        return AsciiRenderer::maxOutputSize(toRenderParams(params), width, height);
+    } catch (...) {
+        return 0;
+    }
+}
+
+size_t tv_render(tv_renderer* renderer, const tv_frame* frame, const tv_render_params* params,
+                 char* out, size_t capacity) {
+    if (!renderer || !frame || !out) return 0;
+    try {
+        return renderer->renderer.render(toPixelBuffer(*frame), toRenderParams(params), out, capacity);
+    } catch (...) {
+        return 0;
+    }
+}
+
+size_t tv_render_batch(tv_renderer* renderer, const tv_frame* frames, size_t count,
+                       const tv_render_params* params, char* out, size_t capacity, size_t* lengths) {
+    if (!renderer || !frames || !out) return 0;
+    try {
+        std::vector<PixelBuffer> buffers(count);
+        for (size_t i = 0; i < count; ++i) buffers[i] = toPixelBuffer(frames[i]);
+        return renderer->renderer.renderBatch(buffers.data(), count, toRenderParams(params), out, capacity, lengths);
+    } catch (...) {
+        return 0;
+    }
+}
@@ -0,0 +1,199 @@
+#include "thumbnail_index.hpp"
+#include "frame_source.hpp"
+#include "frame_timing.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// ioprio_set(2) has no glibc wrapper or header constants
+const int IOPRIO_WHO_PROCESS = 1;
+const int IOPRIO_CLASS_IDLE = 3;
+const int IOPRIO_CLASS_SHIFT = 13;
+
+// Nice 19 and idle I/O for the calling thread only; threads it starts
+// (decoder workers, readahead) inherit both
+void lowerPriority() {
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 19);
+#ifdef SYS_ioprio_set
+    syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#endif
+}
+
+} // namespace
+
+void ThumbnailIndex::start(const std::string& path, double interval_ms, RenderParams::ColorMode color_mode,
+                           bool blocks) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        thumbnails.clear();
+        length_ms = 0.0;
+        complete = false;
+        request_path = path;
+        request_interval_ms = interval_ms;
+        request_params = RenderParams();
+        request_params.width = THUMBNAIL_WIDTH;
+        request_params.height = THUMBNAIL_HEIGHT;
+        request_params.color_mode = color_mode;
+        request_params.block_mode = blocks;
+        quitting = false;
+        generation++;
+    }
+    wake.notify_all();
+    if (!thread.joinable()) thread = std::thread(&ThumbnailIndex::run, this);
+}
+
+void ThumbnailIndex::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+        generation++;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void ThumbnailIndex::run() {
+    lowerPriority();
+    uint64_t served = 0;
+    while (true) {
+        std::string path;
+        double interval_ms;
+        RenderParams params;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return quitting || generation != served; });
+            if (quitting) return;
+            served = generation;
+            path = request_path;
+            interval_ms = request_interval_ms;
+            params = request_params;
+        }
+        // The old item's decoder is torn down here too, off the caller's thread
+        index(path, interval_ms, params, served);
+    }
+}
+
+void ThumbnailIndex::index(const std::string& path, double interval_ms, const RenderParams& params, uint64_t job) {
+    // Its own decoder, kept out of the animation cache
+    std::unique_ptr<FrameSource> source = FrameSource::open(path, false);
+    if (!source) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation == job) complete = true;
+        return;
+    }
+    double nominal = nominalFrameInterval(source->fps());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation == job) length_ms = std::max(source->frameCount(), 0) * nominal;
+    }
+    // Sources that decode at reduced size only need enough pixels for the thumbnail
+    cv::Size grid = AsciiRenderer::gridSize(source->frameWidth(), source->frameHeight(), params.width, params.height);
+    source->setTargetSize(grid.width, grid.height * 2);
+
+    AsciiRenderer renderer;
+    FrameTimestamps timestamps(nominal);
+    bool seekable = true;
+    double next_ms = 0.0;
+    cv::Mat frame;
+    while (generation == job && source->read(frame)) {
+        double media_ms = timestamps.next(source->timestamp());
+        // Decoding forward, or a seek that landed short of the target
+        if (media_ms + timestamps.interval() / 2 < next_ms) continue;
+
+        Thumbnail thumbnail;
+        thumbnail.media_ms = media_ms;
+        renderer.renderCells(frame, params, thumbnail.cells);
+        add(std::move(thumbnail), job);
+
+        // Seeks may land a little short, so the next target is always further on
+        next_ms += interval_ms;
+        if (next_ms <= media_ms) next_ms = (std::floor(media_ms / interval_ms) + 1.0) * interval_ms;
+        if (seekable && source->seek(timestamps.origin() + next_ms)) {
+            timestamps.seek(next_ms);
+        } else {
+            seekable = false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation == job) complete = true;
+}
+
+void ThumbnailIndex::add(Thumbnail thumbnail, uint64_t job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Finished after start() moved on to another item
+    if (generation != job) return;
+    // A seek that landed on a frame already indexed
+    if (!thumbnails.empty() && thumbnail.media_ms <= thumbnails.back().media_ms) return;
+    thumbnails.push_back(std::move(thumbnail));
+}
+
+bool ThumbnailIndex::nearest(double media_ms, Thumbnail& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (thumbnails.empty()) return false;
+    auto after = std::lower_bound(thumbnails.begin(), thumbnails.end(), media_ms,
+                                  [](const Thumbnail& t, double ms) { return t.media_ms < ms; });
+    auto best = after;
+    if (after == thumbnails.end() ||
+        (after != thumbnails.begin() && media_ms - (after - 1)->media_ms < after->media_ms - media_ms)) {
+        best = after - 1;
+    }
+    out = *best;
+    return true;
+}
+
+double ThumbnailIndex::progress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (complete) return 1.0;
+    if (length_ms <= 0.0 || thumbnails.empty()) return 0.0;
+    return std::min(thumbnails.back().media_ms / length_ms, 1.0);
+}
+
+size_t ThumbnailIndex::count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return thumbnails.size();
+}
+
+size_t ThumbnailIndex::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t bytes = thumbnails.capacity() * sizeof(Thumbnail);
+    for (const auto& thumbnail : thumbnails) {
+        bytes += static_cast<size_t>(thumbnail.cells.width()) * thumbnail.cells.height() * sizeof(Cell);
+    }
+    return bytes;
+}
+
+void ThumbnailIndex::appendPreview(const CellGrid& cells, int row, int col, std::string& out) {
+    std::string border = "+" + std::string(cells.width(), '-') + "+";
+    auto moveTo = [&](int y) { out += "\033[" + std::to_string(row + y) + ";" + std::to_string(col) + "H"; };
+
+    moveTo(0);
+    out += "\033[0m" + border;
+    for (int y = 0; y < cells.height(); ++y) {
+        moveTo(y + 1);
+        out += '|';
+        const Cell* line = cells.row(y);
+        CellColor pen_fg, pen_bg;
+        for (int x = 0; x < cells.width(); ++x) {
+            const Cell& cell = line[x];
+            if (x == 0 || cell.fg != pen_fg || cell.bg != pen_bg) {
+                out += "\033[";
+                appendSgrColor(out, cell.fg, false);
+                out += ';';
+                appendSgrColor(out, cell.bg, true);
+                out += 'm';
+                pen_fg = cell.fg;
+                pen_bg = cell.bg;
+            }
+            out += cell.ch;
+        }
+        out += "\033[0m|";
+    }
+    moveTo(cells.height() + 1);
+    out += border;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "ascii_renderer.hpp"
+#include "cell_grid.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Tiny cell-grid pictures of a video, one every few seconds, for scrub
+// previews. A thread at the lowest CPU and I/O priority opens its own
+// decoder, seeks to each point (or decodes straight through sources that
+// can't seek) and renders the frame it lands on. A thumbnail is a few
+// kilobytes, so an hour of video at one per 10 s stays near a megabyte.
+// The one thread lives until stop() and switches items when asked, so the
+// caller never waits for a seek or a decoder teardown on the old item.
+class ThumbnailIndex {
+public:
+    static const int THUMBNAIL_WIDTH = 32;
+    static const int THUMBNAIL_HEIGHT = 9;
+
+    struct Thumbnail {
+        double media_ms = 0.0;   // from the item's first frame, like the player's media time
+        CellGrid cells;
+    };
+
+    ThumbnailIndex() = default;
+    ~ThumbnailIndex() { stop(); }
+    ThumbnailIndex(const ThumbnailIndex&) = delete;
+    ThumbnailIndex& operator=(const ThumbnailIndex&) = delete;
+
+    // Drops the current index and starts on `path`; returns right away
+    void start(const std::string& path, double interval_ms, RenderParams::ColorMode color_mode, bool blocks);
+    // Ends the thread, waiting for it
+    void stop();
+
+    // Thumbnail closest to `media_ms`; false while there is none
+    bool nearest(double media_ms, Thumbnail& out) const;
+    // Fraction of the item covered so far, 1 once indexing finished
+    double progress() const;
+    size_t count() const;
+    size_t memoryUsage() const;
+
+    // The thumbnail in a one-cell border whose top-left corner is at
+    // screen row/column `row`, `col` (1-based)
+    static void appendPreview(const CellGrid& cells, int row, int col, std::string& out);
+
+private:
+    void run();
+    void index(const std::string& path, double interval_ms, const RenderParams& params, uint64_t job);
+    void add(Thumbnail thumbnail, uint64_t job);
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    // Bumped by every start() and stop(); the item being indexed is
+    // abandoned as soon as it changes
+    std::atomic<uint64_t> generation{0};
+    bool quitting = false;
+    std::string request_path;
+    double request_interval_ms = 0.0;
+    RenderParams request_params;
+    std::vector<Thumbnail> thumbnails;   // in media time order
+    double length_ms = 0.0;              // expected item length, 0 if unknown
+    bool complete = false;
+};
@@ -0,0 +1,336 @@
+// Quality/size/CPU evaluation of every renderer and color mode. Each frame of
+// the corpus is rendered, the bytes are decoded through the VtScreen model and
+// rasterized back to pixels with a simple cell model, then compared against
+// the source scaled to the same size. Prints a table with the Pareto-optimal
+// configurations marked, so defaults can be picked per deployment.
+//
+// Usage: encoder_eval [options] FILE...
+//   --frames N       frames sampled per file (default 60)
+//   --stride K       use every K-th frame (default 5)
+//   --width W        grid width (default 120)
+//   --height H       grid height (default 40)
+//   --fps F          frame rate used for the bandwidth column (default 30)
+//   --link KBPS      also recommend the best configuration for this link
+#include "ascii_renderer.hpp"
+#include "refine_renderer.hpp"
+#include "vt_screen.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Pixels per cell in the rasterized result, close to the 2.2 cell aspect
+// the grid is sized for. Each quadrant is a 2x4 block.
+const int CELL_WIDTH = 4;
+const int CELL_HEIGHT = 9;
+
+// Default colors of the modeled terminal: light text on a black background
+const cv::Vec3b DEFAULT_FG(229, 229, 229);
+const cv::Vec3b DEFAULT_BG(0, 0, 0);
+
+struct Candidate {
+    std::string name;
+    // Renders into a grid fitted to `target`, like the player does
+    std::function<void(const cv::Mat&, const cv::Size&, std::string&)> render;
+};
+
+struct Totals {
+    size_t frames = 0;
+    double psnr = 0.0;
+    double ssim = 0.0;
+    double bytes = 0.0;
+    double cpu_ns = 0.0;
+    bool pareto = false;
+};
+
+// xterm-256 palette entry as BGR
+cv::Vec3b paletteColor(int index) {
+    uint8_t rgb[3];
+    xtermPaletteColor(index, rgb);
+    return cv::Vec3b(rgb[2], rgb[1], rgb[0]);
+}
+
+cv::Vec3b resolve(const CellColor& color, const cv::Vec3b& fallback) {
+    switch (color.kind) {
+        case CellColor::INDEXED: return paletteColor(color.index);
+        case CellColor::RGB: return cv::Vec3b(color.b, color.g, color.r);
+        default: return fallback;
+    }
+}
+
+// Blend foreground over background by each glyph quadrant's ink coverage
+void rasterize(const CellGrid& cells, int cols, int rows, cv::Mat& out) {
+    out.create(rows * CELL_HEIGHT, cols * CELL_WIDTH, CV_8UC3);
+    for (int cy = 0; cy < rows; ++cy) {
+        for (int cx = 0; cx < cols; ++cx) {
+            const Cell& cell = cells.at(cx, cy);
+            cv::Vec3b fg = resolve(cell.fg, DEFAULT_FG);
+            cv::Vec3b bg = resolve(cell.bg, DEFAULT_BG);
+            float q[4];
+            glyphCoverage(cell.ch, AsciiRenderer::ASCII_CHARS, q);
+            for (int py = 0; py < CELL_HEIGHT; ++py) {
+                cv::Vec3b* row = out.ptr<cv::Vec3b>(cy * CELL_HEIGHT + py) + cx * CELL_WIDTH;
+                for (int px = 0; px < CELL_WIDTH; ++px) {
+                    float a = q[(py * 2 >= CELL_HEIGHT ? 2 : 0) + (px * 2 >= CELL_WIDTH ? 1 : 0)];
+                    for (int c = 0; c < 3; ++c) {
+                        row[px][c] = static_cast<uint8_t>(std::lround(bg[c] + (fg[c] - bg[c]) * a));
+                    }
+                }
+            }
+        }
+    }
+}
+
+double psnr(const cv::Mat& a, const cv::Mat& b) {
+    double sum = 0.0;
+    for (int y = 0; y < a.rows; ++y) {
+        const uint8_t* pa = a.ptr<uint8_t>(y);
+        const uint8_t* pb = b.ptr<uint8_t>(y);
+        for (int x = 0; x < a.cols * 3; ++x) {
+            double d = static_cast<double>(pa[x]) - pb[x];
+            sum += d * d;
+        }
+    }
+    double mse = sum / (static_cast<double>(a.rows) * a.cols * 3);
+    return mse <= 1e-10 ? 100.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+// Mean SSIM of the luma planes over non-overlapping 8x8 windows
+double ssim(const cv::Mat& a, const cv::Mat& b) {
+    const double C1 = (0.01 * 255) * (0.01 * 255);
+    const double C2 = (0.03 * 255) * (0.03 * 255);
+    cv::Mat ga, gb;
+    cv::cvtColor(a, ga, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(b, gb, cv::COLOR_BGR2GRAY);
+
+    double total = 0.0;
+    int windows = 0;
+    for (int wy = 0; wy + 8 <= ga.rows; wy += 8) {
+        for (int wx = 0; wx + 8 <= ga.cols; wx += 8) {
+            double sa = 0, sb = 0, saa = 0, sbb = 0, sab = 0;
+            for (int y = wy; y < wy + 8; ++y) {
+                const uint8_t* pa = ga.ptr<uint8_t>(y);
+                const uint8_t* pb = gb.ptr<uint8_t>(y);
+                for (int x = wx; x < wx + 8; ++x) {
+                    sa += pa[x];
+                    sb += pb[x];
+                    saa += pa[x] * pa[x];
+                    sbb += pb[x] * pb[x];
+                    sab += pa[x] * pb[x];
+                }
+            }
+            double ma = sa / 64, mb = sb / 64;
+            double va = saa / 64 - ma * ma, vb = sbb / 64 - mb * mb, cov = sab / 64 - ma * mb;
+            total += ((2 * ma * mb + C1) * (2 * cov + C2)) / ((ma * ma + mb * mb + C1) * (va + vb + C2));
+            windows++;
+        }
+    }
+    return windows ? total / windows : 1.0;
+}
+
+std::vector<Candidate> buildCandidates() {
+    std::vector<Candidate> candidates;
+    struct Mode { const char* name; RenderParams::ColorMode mode; bool blocks; };
+    const Mode modes[] = {
+        {"mono", RenderParams::MONO, false},
+        {"8bit", RenderParams::COLOR_8BIT, false},
+        {"24bit", RenderParams::COLOR_24BIT, false},
+        {"block-8bit", RenderParams::COLOR_8BIT, true},
+        {"block-24bit", RenderParams::COLOR_24BIT, true},
+    };
+
+    // One renderer per configuration, so each keeps its own warm caches
+    auto renderers = std::make_shared<std::vector<AsciiRenderer>>(sizeof(modes) / sizeof(modes[0]));
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i) {
+        Mode m = modes[i];
+        candidates.push_back({std::string("realtime-") + m.name,
+            [renderers, i, m](const cv::Mat& frame, const cv::Size& target, std::string& out) {
+                RenderParams params;
+                params.color_mode = m.mode;
+                params.block_mode = m.blocks;
+                params.width = target.width;
+                params.height = target.height;
+                (*renderers)[i].render(frame, params, out);
+            }});
+    }
+    for (const Mode& m : modes) {
+        candidates.push_back({std::string("refine-") + m.name,
+            [m](const cv::Mat& frame, const cv::Size& target, std::string& out) {
+                static const std::atomic<bool> never(false);
+                cv::Size grid = AsciiRenderer::gridSize(frame.cols, frame.rows, target.width, target.height);
+                RefineParams params;
+                params.grid_width = grid.width;
+                params.grid_height = grid.height;
+                params.color_mode = static_cast<int>(m.mode);
+                params.block_mode = m.blocks;
+                params.charset = AsciiRenderer::ASCII_CHARS;
+                out = refineFrame(frame, params, never);
+            }});
+    }
+    return candidates;
+}
+
+std::vector<cv::Mat> loadFrames(const std::string& path, int max_frames, int stride) {
+    std::vector<cv::Mat> frames;
+    cv::VideoCapture cap(path);
+    if (cap.isOpened()) {
+        cv::Mat frame;
+        for (int i = 0; static_cast<int>(frames.size()) < max_frames && cap.read(frame); ++i) {
+            if (i % stride == 0) frames.push_back(frame.clone());
+        }
+    }
+    if (frames.empty()) {
+        cv::Mat image = cv::imread(path);
+        if (!image.empty()) frames.push_back(image);
+    }
+    return frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int max_frames = 60;
+    int stride = 5;
+    int grid_width = AsciiRenderer::DEFAULT_WIDTH;
+    int grid_height = AsciiRenderer::DEFAULT_HEIGHT;
+    double fps = 30.0;
+    double link_kbps = 0.0;
+    std::vector<std::string> corpus;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) max_frames = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--stride" && i + 1 < argc) stride = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--width" && i + 1 < argc) grid_width = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--height" && i + 1 < argc) grid_height = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--fps" && i + 1 < argc) fps = std::max(std::atof(argv[++i]), 1.0);
+        else if (arg == "--link" && i + 1 < argc) link_kbps = std::atof(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-') corpus.push_back(arg);
+        else {
+            corpus.clear();
+            break;
+        }
+    }
+    if (corpus.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--frames N] [--stride K] [--width W] [--height H] [--fps F] [--link KBPS] FILE...\n";
+        return 2;
+    }
+
+    std::vector<Candidate> candidates = buildCandidates();
+    std::vector<Totals> totals(candidates.size());
+    std::string bytes;
+    cv::Mat reference, decoded;
+
+    for (const auto& path : corpus) {
+        std::vector<cv::Mat> frames = loadFrames(path, max_frames, stride);
+        if (frames.empty()) {
+            std::cerr << "Warning: no frames read from " << path << std::endl;
+            continue;
+        }
+        std::cout << path << ": " << frames.size() << " frames" << std::endl;
+
+        for (const auto& frame : frames) {
+            cv::Size grid = AsciiRenderer::gridSize(frame.cols, frame.rows, grid_width, grid_height);
+            if (grid.width <= 0 || grid.height <= 0) continue;
+            cv::resize(frame, reference, cv::Size(grid.width * CELL_WIDTH, grid.height * CELL_HEIGHT), 0, 0,
+                       cv::INTER_AREA);
+
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                std::clock_t start = std::clock();
+                candidates[c].render(frame, cv::Size(grid_width, grid_height), bytes);
+                std::clock_t end = std::clock();
+
+                // One spare row absorbs the newline after the last line
+                VtScreen screen(grid.width, grid.height + 1);
+                screen.feed(bytes);
+                rasterize(screen.grid(), grid.width, grid.height, decoded);
+
+                Totals& t = totals[c];
+                t.frames++;
+                t.psnr += psnr(reference, decoded);
+                t.ssim += ssim(reference, decoded);
+                t.bytes += bytes.size();
+                t.cpu_ns += (end - start) * 1e9 / CLOCKS_PER_SEC;
+            }
+        }
+    }
+
+    for (auto& t : totals) {
+        if (t.frames == 0) continue;
+        t.psnr /= t.frames;
+        t.ssim /= t.frames;
+        t.bytes /= t.frames;
+        t.cpu_ns /= t.frames;
+    }
+    if (totals.empty() || totals[0].frames == 0) {
+        std::cerr << "Error: no frames evaluated" << std::endl;
+        return 1;
+    }
+
+    // Pareto-optimal: no other configuration is at least as good on quality,
+    // size and CPU and strictly better on one of them
+    for (size_t a = 0; a < totals.size(); ++a) {
+        totals[a].pareto = true;
+        for (size_t b = 0; b < totals.size() && totals[a].pareto; ++b) {
+            const Totals& x = totals[a];
+            const Totals& y = totals[b];
+            bool no_worse = y.ssim >= x.ssim && y.bytes <= x.bytes && y.cpu_ns <= x.cpu_ns;
+            bool better = y.ssim > x.ssim || y.bytes < x.bytes || y.cpu_ns < x.cpu_ns;
+            if (b != a && no_worse && better) totals[a].pareto = false;
+        }
+    }
+
+    std::vector<size_t> order(candidates.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return totals[a].bytes < totals[b].bytes; });
+
+    std::cout << "\n" << std::left << std::setw(22) << "renderer" << std::right
+              << std::setw(10) << "PSNR dB" << std::setw(8) << "SSIM" << std::setw(13) << "bytes/frame"
+              << std::setw(12) << "kbit/s" << std::setw(14) << "CPU ns/frame" << "  pareto\n";
+    std::cout << std::fixed;
+    for (size_t i : order) {
+        const Totals& t = totals[i];
+        std::cout << std::left << std::setw(22) << candidates[i].name << std::right
+                  << std::setw(10) << std::setprecision(2) << t.psnr
+                  << std::setw(8) << std::setprecision(3) << t.ssim
+                  << std::setw(13) << std::setprecision(0) << t.bytes
+                  << std::setw(12) << t.bytes * 8 * fps / 1000.0
+                  << std::setw(14) << t.cpu_ns
+                  << (t.pareto ? "  *" : "") << "\n";
+    }
+    std::cout << "(kbit/s at " << std::setprecision(1) << fps << " fps; grid up to "
+              << grid_width << "x" << grid_height << ")\n";
+
+    if (link_kbps > 0) {
+        // Best quality among the frontier configurations that fit the link
+        const Totals* best = nullptr;
+        size_t best_index = 0;
+        for (size_t i = 0; i < totals.size(); ++i) {
+            const Totals& t = totals[i];
+            if (!t.pareto || t.bytes * 8 * fps / 1000.0 > link_kbps) continue;
+            if (!best || t.ssim > best->ssim) {
+                best = &t;
+                best_index = i;
+            }
+        }
+        if (best) {
+            std::cout << "Best for " << std::setprecision(0) << link_kbps << " kbit/s: "
+                      << candidates[best_index].name << "\n";
+        } else {
+            std::cout << "Nothing fits " << std::setprecision(0) << link_kbps
+                      << " kbit/s at this grid size and frame rate\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,386 @@
+// Runs the player on a pseudo-terminal that stands in for a slow link:
+// output is consumed at a limited byte rate and reaches the VtScreen model
+// after a fixed delay, so the player sees real backpressure. Keystrokes and
+// window size changes (SIGWINCH) are injected on a schedule, and the
+// measured frame rate, key-to-screen latency and dropped frames can be
+// asserted on. Pass --no-prompt to the player so it starts on its own.
+//
+// Usage: pty_harness [options] -- PLAYER [ARGS...]
+//   --rate BYTES      bytes per second the "terminal" reads (default unlimited)
+//   --delay MS        one-way delay before bytes reach the screen (default 0)
+//   --size COLSxROWS  initial window size (default 100x30)
+//   --duration S      send 'q' after this many seconds (default 10)
+//   --key T:KEY       inject KEY at T seconds (a character, "space" or "esc")
+//   --resize T:CxR    change the window size at T seconds
+//   --min-fps F       fail if the displayed frame rate is below F
+//   --max-latency MS  fail if any key takes longer to show on screen
+//   --max-drops N     fail if more than N frames are skipped
+//   --verbose         log every frame
+#include "vt_screen.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <signal.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Every frame the player shows, in any output mode, ends with the status
+// line, whose key help ends like this (the scrub preview's help does not)
+const std::string FRAME_END = "[0]Reset view [,/.]Seek";
+
+struct Event {
+    double at = 0.0;        // seconds after start
+    char key = 0;           // key to send, or 0 for a resize
+    int cols = 0, rows = 0;
+    bool done = false;
+};
+
+struct PendingKey {
+    double sent_at;
+    std::string status_before;
+};
+
+struct Delivery {
+    double at;
+    std::string bytes;
+};
+
+bool parseSize(const std::string& text, int& cols, int& rows) {
+    size_t x = text.find('x');
+    if (x == std::string::npos) return false;
+    cols = std::atoi(text.substr(0, x).c_str());
+    rows = std::atoi(text.substr(x + 1).c_str());
+    return cols > 0 && rows > 0;
+}
+
+bool parseEvent(const std::string& text, bool is_key, Event& event) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos) return false;
+    event.at = std::atof(text.substr(0, colon).c_str());
+    std::string value = text.substr(colon + 1);
+    if (!is_key) return parseSize(value, event.cols, event.rows);
+    if (value == "space") event.key = ' ';
+    else if (value == "esc") event.key = 27;
+    else if (value.size() == 1) event.key = value[0];
+    else return false;
+    return true;
+}
+
+std::string rowText(const CellGrid& grid, int y) {
+    std::string text;
+    for (int x = 0; x < grid.width(); ++x) text += grid.at(x, y).ch;
+    size_t end = text.find_last_not_of(' ');
+    return end == std::string::npos ? "" : text.substr(0, end + 1);
+}
+
+// Status line of the frame on screen, or empty if there is none
+std::string findStatus(const CellGrid& grid) {
+    for (int y = 0; y < grid.height(); ++y) {
+        std::string text = rowText(grid, y);
+        if (text.find("] Frame: ") != std::string::npos) return text;
+    }
+    return "";
+}
+
+// Frame number from "Frame: N/T", or -1
+int statusFrame(const std::string& status) {
+    size_t pos = status.find("Frame: ");
+    return pos == std::string::npos ? -1 : std::atoi(status.c_str() + pos + 7);
+}
+
+// The status without the fields that change every frame, so a key's effect
+// shows up as a difference
+std::string statusSettings(const std::string& status) {
+    std::string s = status;
+    size_t frame = s.find("Frame: ");
+    if (frame != std::string::npos) {
+        size_t end = s.find(") ", frame);
+        s.erase(frame, end == std::string::npos ? std::string::npos : end + 2 - frame);
+    }
+    size_t buffer = s.find(" Buffer: ");
+    if (buffer != std::string::npos) s.erase(buffer);
+    return s;
+}
+
+void setWindowSize(int fd, int cols, int rows) {
+    struct winsize ws;
+    std::memset(&ws, 0, sizeof(ws));
+    ws.ws_col = static_cast<unsigned short>(cols);
+    ws.ws_row = static_cast<unsigned short>(rows);
+    ioctl(fd, TIOCSWINSZ, &ws);  // the kernel sends SIGWINCH to the player
+}
+
+// Child side: the slave becomes the controlling terminal and all of stdio
+pid_t spawnOnPty(int& master, int cols, int rows, char** command) {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+    const char* slave_name = ptsname(master);
+    if (!slave_name) return -1;
+    std::string slave_path = slave_name;
+    setWindowSize(master, cols, rows);
+
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    setsid();
+    int slave = open(slave_path.c_str(), O_RDWR);
+    if (slave < 0) _exit(127);
+    ioctl(slave, TIOCSCTTY, 0);
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    dup2(slave, STDERR_FILENO);
+    if (slave > STDERR_FILENO) close(slave);
+    close(master);
+    setenv("TERM", "xterm-256color", 1);
+    execvp(command[0], command);
+    _exit(127);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double rate = 0.0;
+    double delay_s = 0.0;
+    int cols = 100, rows = 30;
+    double duration = 10.0;
+    double min_fps = -1.0, max_latency_ms = -1.0;
+    long max_drops = -1;
+    bool verbose = false;
+    std::vector<Event> events;
+    char** command = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        Event event;
+        if (arg == "--") {
+            if (i + 1 < argc) command = argv + i + 1;
+            break;
+        } else if (arg == "--rate" && has_value) {
+            rate = std::atof(argv[++i]);
+        } else if (arg == "--delay" && has_value) {
+            delay_s = std::atof(argv[++i]) / 1000.0;
+        } else if (arg == "--size" && has_value && parseSize(argv[i + 1], cols, rows)) {
+            ++i;
+        } else if (arg == "--duration" && has_value) {
+            duration = std::atof(argv[++i]);
+        } else if (arg == "--key" && has_value && parseEvent(argv[i + 1], true, event)) {
+            events.push_back(event);
+            ++i;
+        } else if (arg == "--resize" && has_value && parseEvent(argv[i + 1], false, event)) {
+            events.push_back(event);
+            ++i;
+        } else if (arg == "--min-fps" && has_value) {
+            min_fps = std::atof(argv[++i]);
+        } else if (arg == "--max-latency" && has_value) {
+            max_latency_ms = std::atof(argv[++i]);
+        } else if (arg == "--max-drops" && has_value) {
+            max_drops = std::atol(argv[++i]);
+        } else if (arg == "--verbose" || arg == "-v") {
+            verbose = true;
+        } else {
+            command = nullptr;
+            break;
+        }
+    }
+    if (!command) {
+        std::cerr << "Usage: " << argv[0] << " [--rate BYTES] [--delay MS] [--size COLSxROWS] [--duration S]\n"
+                  << "       [--key T:KEY]... [--resize T:CxR]... [--min-fps F] [--max-latency MS]\n"
+                  << "       [--max-drops N] [--verbose] -- PLAYER [ARGS...]\n";
+        return 2;
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.at < b.at; });
+
+    int master = -1;
+    pid_t child = spawnOnPty(master, cols, rows, command);
+    if (child < 0) {
+        std::cerr << "Error: cannot start the player on a pseudo-terminal" << std::endl;
+        return 1;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    const auto start = Clock::now();
+    auto now_s = [&]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+
+    VtScreen screen(cols, rows);
+    std::deque<Delivery> in_flight;
+    double tokens = 0.0;
+    double last_refill = 0.0;
+    const double burst = rate > 0 ? std::max(rate / 20.0, 256.0) : 0.0;
+
+    size_t frames = 0, bytes_total = 0;
+    long drops = 0;
+    int last_frame_number = -1;
+    double first_frame_at = -1.0, last_frame_at = -1.0;
+    std::string carry;  // tail that may hold the start of a split FRAME_END
+    std::string last_status;
+    std::vector<PendingKey> pending_keys;
+    std::vector<double> latencies;
+    bool quit_sent = false, child_exited = false;
+    double quit_at = 0.0;
+    int exit_status = 0;
+
+    // A frame is complete once its status line is written: inspect it then.
+    // A redraw of the same frame (refinement) is not counted again.
+    auto frameComplete = [&](double at) {
+        std::string status = findStatus(screen.grid());
+        int number = statusFrame(status);
+        if (number > 0 && number == last_frame_number) return;
+        if (number > 0 && last_frame_number > 0 && number > last_frame_number + 1) {
+            drops += number - last_frame_number - 1;
+        }
+        if (number > 0) last_frame_number = number;
+        frames++;
+        if (first_frame_at < 0) first_frame_at = at;
+        last_frame_at = at;
+        if (!status.empty()) {
+            last_status = status;
+            std::string settings = statusSettings(status);
+            for (auto it = pending_keys.begin(); it != pending_keys.end();) {
+                if (settings != it->status_before) {
+                    latencies.push_back((at - it->sent_at) * 1000.0);
+                    it = pending_keys.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        if (verbose) std::cerr << std::fixed << std::setprecision(3) << at << "s frame " << number << "\n";
+    };
+
+    auto deliver = [&](const std::string& bytes, double at) {
+        std::string data = carry + bytes;
+        carry.clear();
+        size_t pos = 0;
+        while (true) {
+            size_t next = data.find(FRAME_END, pos);
+            if (next == std::string::npos) break;
+            size_t end = next + FRAME_END.size();
+            screen.feed(data.data() + pos, end - pos);
+            frameComplete(at);
+            pos = end;
+        }
+        // Hold back text that might be the start of the next frame's end
+        size_t keep = 0;
+        for (size_t n = std::min(FRAME_END.size() - 1, data.size() - pos); n > 0; --n) {
+            if (data.compare(data.size() - n, n, FRAME_END, 0, n) == 0) {
+                keep = n;
+                break;
+            }
+        }
+        screen.feed(data.data() + pos, data.size() - pos - keep);
+        carry = data.substr(data.size() - keep);
+    };
+
+    while (true) {
+        double now = now_s();
+
+        for (auto& event : events) {
+            if (event.done || event.at > now) continue;
+            event.done = true;
+            if (event.key) {
+                // Latency is measured against the last complete status line
+                if (write(master, &event.key, 1) == 1 && !last_status.empty()) {
+                    pending_keys.push_back({now, statusSettings(last_status)});
+                }
+            } else {
+                setWindowSize(master, event.cols, event.rows);
+                screen = VtScreen(event.cols, event.rows);
+            }
+        }
+        if (!quit_sent && now >= duration) {
+            char q = 'q';
+            if (write(master, &q, 1) == 1) {
+                quit_sent = true;
+                quit_at = now;
+            }
+        }
+        if (quit_sent && !child_exited && now - quit_at > 3.0) kill(child, SIGKILL);
+
+        // Read only what the simulated link can carry, so the pty fills up
+        size_t allowance = 65536;
+        if (rate > 0) {
+            tokens = std::min(tokens + (now - last_refill) * rate, burst);
+            allowance = static_cast<size_t>(tokens);
+        }
+        last_refill = now;
+        if (allowance > 0 && !child_exited) {
+            char buffer[65536];
+            ssize_t n = read(master, buffer, std::min(allowance, sizeof(buffer)));
+            if (n > 0) {
+                if (rate > 0) tokens -= n;
+                bytes_total += static_cast<size_t>(n);
+                in_flight.push_back({now + delay_s, std::string(buffer, static_cast<size_t>(n))});
+            }
+        }
+        while (!in_flight.empty() && in_flight.front().at <= now) {
+            deliver(in_flight.front().bytes, now);
+            in_flight.pop_front();
+        }
+
+        if (!child_exited) {
+            int status = 0;
+            if (waitpid(child, &status, WNOHANG) == child) {
+                child_exited = true;
+                exit_status = status;
+            }
+        }
+        if (child_exited && in_flight.empty()) break;
+
+        struct pollfd pfd = {master, POLLIN, 0};
+        poll(&pfd, 1, (allowance > 0 && !child_exited) ? 2 : 1);
+    }
+    close(master);
+
+    double span = last_frame_at - first_frame_at;
+    double fps = (frames > 1 && span > 0) ? (frames - 1) / span : 0.0;
+    double latency_max = 0.0, latency_sum = 0.0;
+    for (double l : latencies) {
+        latency_max = std::max(latency_max, l);
+        latency_sum += l;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Frames: " << frames << " (" << fps << " fps)\n"
+              << "Dropped: " << drops << "\n"
+              << "Bytes: " << bytes_total << " (" << (frames ? bytes_total / frames : 0) << "/frame)\n"
+              << "Key latency: " << latencies.size() << " keys, avg "
+              << (latencies.empty() ? 0.0 : latency_sum / latencies.size()) << " ms, max " << latency_max << " ms";
+    if (!pending_keys.empty()) std::cout << " (" << pending_keys.size() << " never shown)";
+    std::cout << "\nUnsupported sequences: " << screen.unsupportedCount();
+    if (screen.unsupportedCount()) std::cout << " (last: " << screen.lastUnsupported() << ")";
+    std::cout << "\nPlayer exit: "
+              << (WIFEXITED(exit_status) ? "status " + std::to_string(WEXITSTATUS(exit_status))
+                                         : "signal " + std::to_string(WTERMSIG(exit_status)))
+              << "\n";
+
+    bool ok = true;
+    if (min_fps >= 0 && fps < min_fps) {
+        std::cout << "FAIL: " << fps << " fps is below " << min_fps << "\n";
+        ok = false;
+    }
+    if (max_latency_ms >= 0 && (latency_max > max_latency_ms || !pending_keys.empty())) {
+        std::cout << "FAIL: key latency above " << max_latency_ms << " ms\n";
+        ok = false;
+    }
+    if (max_drops >= 0 && drops > max_drops) {
+        std::cout << "FAIL: " << drops << " dropped frames, limit " << max_drops << "\n";
+        ok = false;
+    }
+    std::cout << (ok ? "PASS" : "FAIL") << "\n";
+    return ok ? 0 : 1;
+}
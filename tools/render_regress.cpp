@@ -0,0 +1,381 @@
+// Output and throughput regression check for the renderers. Renders fixed
+// synthetic sequences with every renderer and color mode and
+//  - requires all entry points (cv::Mat, PixelBuffer, renderBatch, the C ABI,
+//    cold and warm caches) to produce byte-identical output,
+//  - compares output hashes against a golden file,
+//  - fails if frames/s drops below this machine's stored baseline by more
+//    than the tolerance.
+// Golden hashes depend on the OpenCV build (resize, equalizeHist), and the
+// baseline on the machine, so both are recorded locally with --update.
+// Without a golden file the other checks still run, and the exit status is
+// SKIP_STATUS (77, CTest's usual skip code) unless one of them fails; a
+// missing baseline only skips the throughput comparison.
+//
+// The sixel encoder must also keep up with --realtime-fps at 640x360.
+// Timing is noisy on shared machines, so --perf-warn reports throughput
+// and real-time misses as warnings instead of failures.
+//
+// Usage: render_regress [--golden FILE] [--baseline FILE] [--tolerance F]
+//                       [--repeat N] [--realtime-fps F] [--perf-warn] [--update]
+#include "ascii_renderer.hpp"
+#include "refine_renderer.hpp"
+#include "sixel_encoder.hpp"
+#include "terminal_video.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int SKIP_STATUS = 77;
+
+struct Sequence {
+    std::string name;
+    std::vector<cv::Mat> frames;
+};
+
+struct Config {
+    std::string name;
+    RenderParams params;
+    bool refine = false;
+    bool sixel = false;
+};
+
+// Deterministic across platforms, unlike the <random> distributions
+uint32_t hashNoise(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+uint64_t fnv1a(const std::string& data, uint64_t hash = 1469598103934665603ULL) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string hex(uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+// Odd sizes and a padded view exercise strides that are not width * 3
+std::vector<Sequence> buildSequences() {
+    std::vector<Sequence> sequences;
+    const int FRAMES = 24;
+
+    Sequence pan{"gradient-320x180", {}};
+    for (int t = 0; t < FRAMES; ++t) {
+        cv::Mat frame(180, 320, CV_8UC3);
+        for (int y = 0; y < frame.rows; ++y) {
+            cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < frame.cols; ++x) {
+                row[x] = cv::Vec3b(static_cast<uint8_t>((x + t * 7) & 255), static_cast<uint8_t>(y * 255 / 179),
+                                   static_cast<uint8_t>((x ^ y) & 255));
+            }
+        }
+        pan.frames.push_back(frame);
+    }
+    sequences.push_back(pan);
+
+    Sequence noise{"noise-97x61", {}};
+    for (int t = 0; t < FRAMES; ++t) {
+        cv::Mat frame(61, 97, CV_8UC3);
+        for (int y = 0; y < frame.rows; ++y) {
+            cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < frame.cols; ++x) {
+                uint32_t n = hashNoise(static_cast<uint32_t>((t * 61 + y) * 97 + x));
+                row[x] = cv::Vec3b(static_cast<uint8_t>(n), static_cast<uint8_t>(n >> 8), static_cast<uint8_t>(n >> 16));
+            }
+        }
+        noise.frames.push_back(frame);
+    }
+    sequences.push_back(noise);
+
+    Sequence box{"box-641x359-view", {}};
+    for (int t = 0; t < FRAMES; ++t) {
+        cv::Mat padded(363, 651, CV_8UC3, cv::Scalar(40, 40, 40));
+        cv::Mat frame = padded(cv::Rect(5, 2, 641, 359));
+        int bx = (t * 23) % 500;
+        for (int y = 0; y < frame.rows; ++y) {
+            cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < frame.cols; ++x) {
+                bool inside = x >= bx && x < bx + 140 && y >= 100 && y < 260;
+                bool white = ((x / 16 + y / 16) & 1) != 0;
+                row[x] = inside ? cv::Vec3b(30, 60, 230) : (white ? cv::Vec3b(255, 255, 255) : cv::Vec3b(0, 0, 0));
+            }
+        }
+        box.frames.push_back(frame);
+    }
+    sequences.push_back(box);
+    return sequences;
+}
+
+std::vector<Config> buildConfigs() {
+    struct Mode { const char* name; RenderParams::ColorMode mode; bool blocks; };
+    const Mode modes[] = {
+        {"mono", RenderParams::MONO, false},
+        {"8bit", RenderParams::COLOR_8BIT, false},
+        {"24bit", RenderParams::COLOR_24BIT, false},
+        {"block-8bit", RenderParams::COLOR_8BIT, true},
+        {"block-24bit", RenderParams::COLOR_24BIT, true},
+    };
+    std::vector<Config> configs;
+    for (const Mode& m : modes) {
+        for (int refine = 0; refine < 2; ++refine) {
+            Config c;
+            c.name = std::string(refine ? "refine-" : "realtime-") + m.name;
+            c.params.color_mode = m.mode;
+            c.params.block_mode = m.blocks;
+            c.params.width = 100;
+            c.params.height = 36;
+            c.refine = refine != 0;
+            configs.push_back(c);
+        }
+    }
+    for (int gray = 0; gray < 2; ++gray) {
+        Config c;
+        c.name = gray ? "sixel-gray" : "sixel-color";
+        c.params.color_mode = gray ? RenderParams::MONO : RenderParams::COLOR_24BIT;
+        c.params.width = SixelEncoder::DEFAULT_WIDTH;
+        c.params.height = SixelEncoder::DEFAULT_HEIGHT;
+        c.sixel = true;
+        configs.push_back(c);
+    }
+    return configs;
+}
+
+PixelBuffer toPixels(const cv::Mat& frame) {
+    PixelBuffer pixels;
+    pixels.data = frame.data;
+    pixels.width = frame.cols;
+    pixels.height = frame.rows;
+    pixels.stride = frame.step;
+    return pixels;
+}
+
+// Every real-time entry point must agree with the warm cv::Mat path
+bool checkEntryPoints(const Config& config, const Sequence& seq, const std::vector<std::string>& expected,
+                      std::string& failure) {
+    AsciiRenderer buffer_renderer;
+    std::vector<char> out;
+    for (size_t i = 0; i < seq.frames.size(); ++i) {
+        const cv::Mat& frame = seq.frames[i];
+        size_t capacity = AsciiRenderer::maxOutputSize(config.params, frame.cols, frame.rows);
+        out.resize(capacity);
+
+        AsciiRenderer cold;
+        if (cold.render(frame, config.params) != expected[i]) {
+            failure = "cold-cache render differs at frame " + std::to_string(i);
+            return false;
+        }
+        size_t n = buffer_renderer.render(toPixels(frame), config.params, out.data(), capacity);
+        if (std::string(out.data(), n) != expected[i]) {
+            failure = "PixelBuffer render differs at frame " + std::to_string(i);
+            return false;
+        }
+    }
+
+    // The whole sequence as one batch, through the C ABI
+    std::vector<tv_frame> frames;
+    size_t capacity = 0;
+    for (const auto& frame : seq.frames) {
+        frames.push_back({frame.data, frame.cols, frame.rows, frame.step});
+    }
+    tv_render_params params = {config.params.width, config.params.height,
+                               static_cast<tv_color_mode>(config.params.color_mode), config.params.block_mode ? 1 : 0};
+    for (const auto& frame : seq.frames) capacity += tv_max_output_size(&params, frame.cols, frame.rows);
+    out.resize(capacity);
+    std::vector<size_t> lengths(frames.size());
+    tv_renderer* renderer = tv_renderer_create();
+    size_t total = tv_render_batch(renderer, frames.data(), frames.size(), &params, out.data(), capacity, lengths.data());
+    tv_renderer_destroy(renderer);
+    if (total == 0) {
+        failure = "tv_render_batch failed";
+        return false;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (std::string(out.data() + offset, lengths[i]) != expected[i]) {
+            failure = "C ABI batch differs at frame " + std::to_string(i);
+            return false;
+        }
+        offset += lengths[i];
+    }
+    return true;
+}
+
+std::map<std::string, std::string> loadTable(const std::string& path) {
+    std::map<std::string, std::string> table;
+    std::ifstream in(path);
+    std::string key, value;
+    while (in >> key >> value) table[key] = value;
+    return table;
+}
+
+bool saveTable(const std::string& path, const std::map<std::string, std::string>& table) {
+    std::ofstream out(path);
+    for (const auto& entry : table) out << entry.first << " " << entry.second << "\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string golden_path = "render_golden.txt";
+    std::string baseline_path = "render_baseline.txt";
+    double tolerance = 0.15;
+    int repeat = 3;
+    double realtime_fps = 30.0;
+    bool update = false;
+    bool perf_warn = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--golden" && i + 1 < argc) golden_path = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc) baseline_path = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc) tolerance = std::atof(argv[++i]);
+        else if (arg == "--repeat" && i + 1 < argc) repeat = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--realtime-fps" && i + 1 < argc) realtime_fps = std::atof(argv[++i]);
+        else if (arg == "--perf-warn") perf_warn = true;
+        else if (arg == "--update") update = true;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--golden FILE] [--baseline FILE] [--tolerance F] [--repeat N]"
+                      << " [--realtime-fps F] [--perf-warn] [--update]\n";
+            return 2;
+        }
+    }
+
+    std::map<std::string, std::string> golden = loadTable(golden_path);
+    std::map<std::string, std::string> baseline = loadTable(baseline_path);
+    std::map<std::string, std::string> new_golden, new_baseline;
+    bool check_hashes = update || !golden.empty();
+    if (!check_hashes) {
+        std::cerr << "Warning: no golden hashes in " << golden_path
+                  << ", output is not compared; run with --update to record them\n";
+    }
+
+    std::vector<Sequence> sequences = buildSequences();
+    std::vector<Config> configs = buildConfigs();
+    const std::atomic<bool> never(false);
+    int failures = 0;
+    int perf_warnings = 0;
+
+    std::cout << std::left << std::setw(22) << "renderer" << std::setw(20) << "sequence" << std::setw(18) << "hash"
+              << std::right << std::setw(10) << "fps" << std::setw(10) << "baseline" << "  result\n";
+
+    for (const auto& config : configs) {
+        for (const auto& seq : sequences) {
+            std::string key = config.name + "/" + seq.name;
+            AsciiRenderer renderer;
+            SixelEncoder sixel;
+            std::vector<std::string> outputs(seq.frames.size());
+            uint64_t hash = fnv1a("");
+            double best_fps = 0.0;
+
+            for (int pass = 0; pass < repeat; ++pass) {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < seq.frames.size(); ++i) {
+                    if (config.refine) {
+                        RefineParams params;
+                        cv::Size grid = AsciiRenderer::gridSize(seq.frames[i].cols, seq.frames[i].rows,
+                                                                config.params.width, config.params.height);
+                        params.grid_width = grid.width;
+                        params.grid_height = grid.height;
+                        params.color_mode = static_cast<int>(config.params.color_mode);
+                        params.block_mode = config.params.block_mode;
+                        params.charset = AsciiRenderer::ASCII_CHARS;
+                        outputs[i] = refineFrame(seq.frames[i], params, never);
+                    } else if (config.sixel) {
+                        SixelParams params;
+                        params.width = config.params.width;
+                        params.height = config.params.height;
+                        params.grayscale = config.params.color_mode == RenderParams::MONO;
+                        sixel.encode(seq.frames[i], params, outputs[i]);
+                    } else {
+                        renderer.render(seq.frames[i], config.params, outputs[i]);
+                    }
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (seconds > 0) best_fps = std::max(best_fps, seq.frames.size() / seconds);
+                if (pass == 0) {
+                    for (const auto& out : outputs) hash = fnv1a(out, hash);
+                }
+            }
+
+            std::string result = "ok";
+            std::string failure;
+            if (!config.refine && !config.sixel && !checkEntryPoints(config, seq, outputs, failure)) {
+                result = "FAIL: " + failure;
+            }
+
+            std::string hash_hex = hex(hash);
+            auto g = golden.find(key);
+            if (!update && check_hashes && g != golden.end() && g->second != hash_hex && result == "ok") {
+                result = "FAIL: output changed (golden " + g->second + ")";
+            } else if (!update && check_hashes && g == golden.end() && result == "ok") {
+                result = "FAIL: no golden hash";
+            }
+
+            std::ostringstream slow;
+            auto b = baseline.find(key);
+            double base_fps = b != baseline.end() ? std::atof(b->second.c_str()) : 0.0;
+            if (config.sixel && realtime_fps > 0 && best_fps < realtime_fps) {
+                slow << "below " << realtime_fps << " fps real-time budget";
+            } else if (!update && base_fps > 0 && best_fps < base_fps * (1.0 - tolerance)) {
+                slow << std::fixed << std::setprecision(0) << (1.0 - best_fps / base_fps) * 100 << "% slower";
+            }
+            if (!slow.str().empty() && result == "ok") {
+                result = (perf_warn ? "WARN: " : "FAIL: ") + slow.str();
+                if (perf_warn) perf_warnings++;
+            }
+            if (result.compare(0, 5, "FAIL:") == 0) failures++;
+
+            std::ostringstream fps_text;
+            fps_text << std::fixed << std::setprecision(1) << best_fps;
+            new_golden[key] = hash_hex;
+            new_baseline[key] = fps_text.str();
+
+            std::cout << std::left << std::setw(22) << config.name << std::setw(20) << seq.name << std::setw(18)
+                      << hash_hex << std::right << std::fixed << std::setprecision(1) << std::setw(10) << best_fps
+                      << std::setw(10) << base_fps << "  " << result << "\n";
+        }
+    }
+
+    if (update) {
+        if (!saveTable(golden_path, new_golden) || !saveTable(baseline_path, new_baseline)) {
+            std::cerr << "Error: cannot write " << golden_path << " or " << baseline_path << "\n";
+            return 1;
+        }
+        std::cout << "Recorded " << new_golden.size() << " hashes in " << golden_path << " and baselines in "
+                  << baseline_path << "\n";
+        // Entry point mismatches are bugs regardless of what gets recorded
+        return failures ? 1 : 0;
+    }
+    if (failures) {
+        std::cout << "FAIL (" << failures << " failing)\n";
+        return 1;
+    }
+    if (perf_warnings) std::cout << perf_warnings << " throughput warnings\n";
+    if (!check_hashes) {
+        std::cout << "SKIP (output hashes not compared)\n";
+        return SKIP_STATUS;
+    }
+    std::cout << "PASS (0 failing)\n";
+    return 0;
+}
@@ -0,0 +1,251 @@
+// Viewer for the player's binary cell stream (--stream, see cell_stream.hpp).
+// Decodes the cells and draws them with escapes suited to this terminal:
+// 24-bit colors pass through, 256-color terminals get the nearest palette
+// entry and mono terminals the characters alone, with block cells turned
+// into brightness characters. The grid is cropped to the window. When it
+// falls behind, the viewer draws only the newest grid it has.
+//
+// Usage: stream_view SOURCE [--colors mono|256|truecolor]
+//   SOURCE    unix:PATH for the player's socket, a file or FIFO, or - for stdin
+//   --colors  what the terminal shows (default from COLORTERM and TERM)
+//
+// Frames, keyframes and bytes per frame on the wire and to the terminal
+// are printed to stderr at the end.
+#include "ascii_renderer.hpp"
+#include "cell_stream.hpp"
+#include "delta_encoder.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+enum Colors { MONO, PALETTE_256, TRUECOLOR };
+
+std::atomic<bool> stop_requested(false);
+std::atomic<bool> resized(false);
+
+void onStop(int) { stop_requested = true; }
+void onResize(int) { resized = true; }
+
+Colors detectColors() {
+    const char* colorterm = std::getenv("COLORTERM");
+    if (colorterm && (std::strcmp(colorterm, "truecolor") == 0 || std::strcmp(colorterm, "24bit") == 0)) {
+        return TRUECOLOR;
+    }
+    const char* term = std::getenv("TERM");
+    if (term && std::strstr(term, "256color")) return PALETTE_256;
+    return MONO;
+}
+
+// Same mapping as the renderer's 8-bit mode
+int paletteIndex(int r, int g, int b) {
+    if (r == g && g == b) {
+        if (r < 8) return 16;
+        if (r > 248) return 231;
+        return static_cast<int>(((r - 8) / 247.0) * 24) + 232;
+    }
+    int ir = static_cast<int>((r / 255.0) * 5);
+    int ig = static_cast<int>((g / 255.0) * 5);
+    int ib = static_cast<int>((b / 255.0) * 5);
+    return 16 + (36 * ir) + (6 * ig) + ib;
+}
+
+// Brightness 0-255 of a color, or -1 for the terminal's default
+int brightness(const CellColor& color) {
+    uint8_t rgb[3] = {color.r, color.g, color.b};
+    if (color.kind == CellColor::DEFAULT) return -1;
+    if (color.kind == CellColor::INDEXED) xtermPaletteColor(color.index, rgb);
+    return static_cast<int>(0.299 * rgb[0] + 0.587 * rgb[1] + 0.114 * rgb[2]);
+}
+
+Cell adapt(const Cell& cell, Colors colors) {
+    Cell out = cell;
+    if (colors == TRUECOLOR) return out;
+    if (colors == PALETTE_256) {
+        if (cell.fg.kind == CellColor::RGB) out.fg = CellColor::indexed(paletteIndex(cell.fg.r, cell.fg.g, cell.fg.b));
+        if (cell.bg.kind == CellColor::RGB) out.bg = CellColor::indexed(paletteIndex(cell.bg.r, cell.bg.g, cell.bg.b));
+        return out;
+    }
+    out.fg = CellColor();
+    out.bg = CellColor();
+    // A block cell is all background; show how bright it is instead
+    int level = cell.ch == ' ' ? brightness(cell.bg) : -1;
+    if (level >= 0) {
+        const std::string& ramp = AsciiRenderer::ASCII_CHARS;
+        out.ch = ramp[static_cast<size_t>(level) * (ramp.size() - 1) / 255];
+    }
+    return out;
+}
+
+void windowSize(int& cols, int& rows) {
+    winsize size = {};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        cols = size.ws_col;
+        rows = size.ws_row;
+    } else {
+        cols = 80;
+        rows = 24;
+    }
+}
+
+int openSource(const std::string& source, bool& socket_source) {
+    socket_source = false;
+    if (source == "-") return STDIN_FILENO;
+    const std::string prefix = "unix:";
+    if (source.compare(0, prefix.size(), prefix) != 0) {
+        int fd = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) std::cerr << "Error: cannot open " << source << ": " << std::strerror(errno) << std::endl;
+        return fd;
+    }
+    std::string path = source.substr(prefix.size());
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: bad socket path " << path << std::endl;
+        return -1;
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Error: cannot connect to " << path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    socket_source = true;
+    return fd;
+}
+
+bool writeAll(const std::string& bytes) {
+    size_t done = 0;
+    while (done < bytes.size()) {
+        ssize_t n = write(STDOUT_FILENO, bytes.data() + done, bytes.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string source;
+    Colors colors = detectColors();
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--colors" && (value == "mono" || value == "256" || value == "truecolor")) {
+            colors = value == "mono" ? MONO : value == "256" ? PALETTE_256 : TRUECOLOR;
+            ++i;
+        } else if (source.empty() && !arg.empty() && (arg == "-" || arg[0] != '-')) {
+            source = arg;
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || source.empty()) {
+        std::cerr << "Usage: " << argv[0] << " SOURCE [--colors mono|256|truecolor]\n"
+                  << "  SOURCE is unix:PATH, a file or FIFO, or - for stdin\n";
+        return 2;
+    }
+
+    bool socket_source = false;
+    int fd = openSource(source, socket_source);
+    if (fd < 0) return 1;
+
+    struct sigaction action = {};
+    action.sa_handler = onStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    action.sa_handler = onResize;
+    sigaction(SIGWINCH, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Alternate screen, hidden cursor
+    writeAll("\033[?1049h\033[?25l\033[2J");
+
+    CellStreamDecoder decoder;
+    DeltaEncoder screen;
+    CellGrid grid, view;
+    int cols, rows;
+    windowSize(cols, rows);
+    size_t wire_bytes = 0, ansi_bytes = 0;
+    size_t frames = 0, keyframes = 0, drawn = 0;
+    std::string error, out;
+    uint8_t buffer[65536];
+
+    while (!stop_requested) {
+        pollfd ready = {fd, POLLIN, 0};
+        int polled = ::poll(&ready, 1, 100);
+        if (polled < 0 && errno != EINTR) break;
+
+        bool redraw = false;
+        if (resized.exchange(false)) {
+            windowSize(cols, rows);
+            // The terminal may have reflowed what it showed: clear and start
+            // over, from a fresh keyframe where the player can send one
+            screen.reset();
+            if (socket_source) {
+                const char request = static_cast<char>(cellstream::KEYFRAME_REQUEST);
+                (void)::send(fd, &request, 1, MSG_NOSIGNAL);
+            }
+            redraw = true;
+        }
+
+        if (polled > 0) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;   // the player stopped
+            wire_bytes += static_cast<size_t>(n);
+            decoder.feed(buffer, static_cast<size_t>(n));
+        }
+        // Everything buffered is applied; only the newest grid is drawn
+        CellStreamDecoder::Result result;
+        while ((result = decoder.next(grid)) == CellStreamDecoder::FRAME) {
+            frames++;
+            if (decoder.lastWasKeyframe()) keyframes++;
+            redraw = true;
+        }
+        if (result == CellStreamDecoder::FAILED) {
+            error = decoder.error();
+            break;
+        }
+        if (!redraw || frames == 0) continue;
+
+        int width = std::min(grid.width(), cols);
+        int height = std::min(grid.height(), rows);
+        if (view.width() != width || view.height() != height) view.resize(width, height);
+        for (int y = 0; y < height; ++y) {
+            const Cell* from = grid.row(y);
+            Cell* to = view.row(y);
+            for (int x = 0; x < width; ++x) to[x] = adapt(from[x], colors);
+        }
+        out.clear();
+        screen.encode(view, out);
+        if (!writeAll(out)) break;
+        ansi_bytes += out.size();
+        drawn++;
+    }
+
+    writeAll("\033[0m\033[?25h\033[?1049l");
+    if (fd != STDIN_FILENO) close(fd);
+
+    if (!error.empty()) std::cerr << "Error: " << error << std::endl;
+    std::cerr << "Frames: " << frames << " received (" << keyframes << " keyframes), " << drawn << " drawn\n"
+              << "Wire: " << (frames > 0 ? wire_bytes / frames : 0) << " bytes/frame, "
+              << "terminal: " << (drawn > 0 ? ansi_bytes / drawn : 0) << " bytes/frame\n";
+    return error.empty() ? 0 : 1;
+}
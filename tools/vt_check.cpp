@@ -0,0 +1,460 @@
+// Property check for the terminal encoders. Renders random synthetic frame
+// sequences with every encoder, replays the bytes through the VtScreen model
+// and requires the resulting screen to equal the cell grid the encoder meant
+// to draw. Reports bytes per frame for each encoder, and for the binary cell
+// stream also the bytes on the wire before a viewer turns them into escapes.
+//
+// Malformed cell streams must be rejected by the decoder without writing
+// outside its grid.
+//
+// Usage: vt_check [--frames N] [--seed S] [--verbose]
+#include "ascii_renderer.hpp"
+#include "cell_stream.hpp"
+#include "delta_encoder.hpp"
+#include "vt_screen.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// An encoder under test: bytes to send for a frame, and the screen contents
+// those bytes must produce. Encoders may keep state between frames.
+class Encoder {
+public:
+    virtual ~Encoder() = default;
+    virtual std::string name() const = 0;
+    // Called when the grid geometry changes (the screen is cleared)
+    virtual void restart(int grid_width, int grid_height) { (void)grid_width; (void)grid_height; }
+    virtual void encode(const cv::Mat& frame, const RenderParams& params, std::string& bytes, CellGrid& expected) = 0;
+    // Bytes of the last frame on the wire, for encoders whose transport isn't the escapes themselves
+    virtual size_t wireBytes() const { return 0; }
+};
+
+// Clear and redraw every frame, as the player does
+class FullFrameEncoder : public Encoder {
+public:
+    FullFrameEncoder(const std::string& name, RenderParams::ColorMode mode, bool blocks)
+        : label(name), color_mode(mode), block_mode(blocks) {}
+
+    std::string name() const override { return label; }
+
+    void encode(const cv::Mat& frame, const RenderParams& base, std::string& bytes, CellGrid& expected) override {
+        RenderParams params = base;
+        params.color_mode = color_mode;
+        params.block_mode = block_mode;
+        bytes = "\033[2J\033[H" + renderer.render(frame, params);
+        renderer.renderCells(frame, params, expected);
+    }
+
+private:
+    std::string label;
+    RenderParams::ColorMode color_mode;
+    bool block_mode;
+    AsciiRenderer renderer;
+};
+
+// A full frame, then alternate fields drawn over it
+class InterlacedEncoder : public Encoder {
+public:
+    InterlacedEncoder(const std::string& name, RenderParams::ColorMode mode, bool blocks)
+        : label(name), color_mode(mode), block_mode(blocks) {}
+
+    std::string name() const override { return label; }
+
+    void restart(int, int) override { next_field = -1; }
+
+    void encode(const cv::Mat& frame, const RenderParams& base, std::string& bytes, CellGrid& expected) override {
+        RenderParams params = base;
+        params.color_mode = color_mode;
+        params.block_mode = block_mode;
+        params.field = next_field;
+        bytes = (next_field < 0 ? "\033[2J\033[H" : "") + renderer.render(frame, params);
+        renderer.renderCells(frame, params, cells);
+        expected = cells;
+        next_field = next_field == 0 ? 1 : 0;
+    }
+
+private:
+    std::string label;
+    RenderParams::ColorMode color_mode;
+    bool block_mode;
+    AsciiRenderer renderer;
+    CellGrid cells;
+    int next_field = -1;
+};
+
+// Changed cells only, optionally within a byte budget; the screen it
+// expects is whatever it has sent so far, not the frame itself
+class DeltaCheckEncoder : public Encoder {
+public:
+    DeltaCheckEncoder(const std::string& name, RenderParams::ColorMode mode, bool blocks, size_t budget)
+        : label(name), color_mode(mode), block_mode(blocks) {
+        delta.setBudget(budget);
+    }
+
+    std::string name() const override { return label; }
+
+    void restart(int, int) override { delta.reset(); }
+
+    void encode(const cv::Mat& frame, const RenderParams& base, std::string& bytes, CellGrid& expected) override {
+        RenderParams params = base;
+        params.color_mode = color_mode;
+        params.block_mode = block_mode;
+        renderer.renderCells(frame, params, cells);
+        delta.encode(cells, bytes);
+        expected = delta.screen();
+    }
+
+private:
+    std::string label;
+    RenderParams::ColorMode color_mode;
+    bool block_mode;
+    AsciiRenderer renderer;
+    DeltaEncoder delta;
+    CellGrid cells;
+};
+
+// The binary cell stream, decoded as a remote viewer would and drawn with
+// the delta encoder on the viewer's side
+class StreamCheckEncoder : public Encoder {
+public:
+    StreamCheckEncoder(const std::string& name, RenderParams::ColorMode mode, bool blocks)
+        : label(name), color_mode(mode), block_mode(blocks) {
+        CellStreamEncoder::appendHeader(header);
+    }
+
+    std::string name() const override { return label; }
+
+    void restart(int, int) override { viewer.reset(); }
+
+    void encode(const cv::Mat& frame, const RenderParams& base, std::string& bytes, CellGrid& expected) override {
+        RenderParams params = base;
+        params.color_mode = color_mode;
+        params.block_mode = block_mode;
+        renderer.renderCells(frame, params, cells);
+        std::string wire = header;
+        header.clear();
+        stream.encode(cells, wire);
+        wire_bytes = wire.size();
+
+        decoder.feed(reinterpret_cast<const uint8_t*>(wire.data()), wire.size());
+        bytes.clear();
+        CellStreamDecoder::Result result;
+        while ((result = decoder.next(received)) == CellStreamDecoder::FRAME) viewer.encode(received, bytes);
+        // A broken stream shows up as a screen mismatch
+        expected = result == CellStreamDecoder::FAILED ? CellGrid() : cells;
+    }
+
+    size_t wireBytes() const override { return wire_bytes; }
+
+private:
+    std::string label;
+    RenderParams::ColorMode color_mode;
+    bool block_mode;
+    AsciiRenderer renderer;
+    CellStreamEncoder stream;
+    CellStreamDecoder decoder;
+    DeltaEncoder viewer;
+    std::string header;
+    CellGrid cells;
+    CellGrid received;
+    size_t wire_bytes = 0;
+};
+
+struct EncoderResult {
+    size_t frames = 0;
+    size_t mismatches = 0;
+    size_t unsupported = 0;
+    size_t total_bytes = 0;
+    size_t max_bytes = 0;
+    size_t wire_bytes = 0;
+    std::string first_failure;
+};
+
+cv::Vec3b randomColor(std::mt19937& rng) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    // Bias towards the extremes, which exercise the edge cases of the palettes
+    std::uniform_int_distribution<int> pick(0, 9);
+    auto channel = [&]() {
+        int p = pick(rng);
+        return static_cast<uint8_t>(p == 0 ? 0 : p == 1 ? 255 : byte(rng));
+    };
+    return cv::Vec3b(channel(), channel(), channel());
+}
+
+// Synthetic scenes that evolve over a short sequence
+class SceneGenerator {
+public:
+    SceneGenerator(std::mt19937& rng, int width, int height) : rng(rng), width(width), height(height) {
+        kind = std::uniform_int_distribution<int>(0, 5)(rng);
+        a = randomColor(rng);
+        b = randomColor(rng);
+        x = std::uniform_int_distribution<int>(0, width - 1)(rng);
+        y = std::uniform_int_distribution<int>(0, height - 1)(rng);
+    }
+
+    cv::Mat next(int t) {
+        cv::Mat frame(height, width, CV_8UC3);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (int py = 0; py < height; ++py) {
+            cv::Vec3b* row = frame.ptr<cv::Vec3b>(py);
+            for (int px = 0; px < width; ++px) {
+                switch (kind) {
+                    case 0: row[px] = a; break;
+                    case 1: { // horizontal gradient, drifting
+                        int v = ((px + t * 3) * 255 / width) % 256;
+                        row[px] = cv::Vec3b(static_cast<uint8_t>(v), static_cast<uint8_t>(255 - v), a[2]);
+                        break;
+                    }
+                    case 2: row[px] = cv::Vec3b(byte(rng), byte(rng), byte(rng)); break;
+                    case 3: { // moving box
+                        bool inside = std::abs(px - (x + t * 4) % width) < width / 4 && std::abs(py - y) < height / 4;
+                        row[px] = inside ? b : a;
+                        break;
+                    }
+                    case 4: // pure white and black stripes
+                        row[px] = ((px / 3 + py / 2 + t) % 2) ? cv::Vec3b(255, 255, 255) : cv::Vec3b(0, 0, 0);
+                        break;
+                    default: // mostly static with sparse random changes
+                        row[px] = (byte(rng) < 8) ? randomColor(rng) : (py < height / 2 ? a : b);
+                        break;
+                }
+            }
+        }
+        return frame;
+    }
+
+private:
+    std::mt19937& rng;
+    int width, height;
+    int kind;
+    cv::Vec3b a, b;
+    int x, y;
+};
+
+std::string describeCell(const Cell& cell) {
+    auto color = [](const CellColor& c) {
+        if (c.kind == CellColor::INDEXED) return "idx" + std::to_string(c.index);
+        if (c.kind == CellColor::RGB) {
+            return "rgb(" + std::to_string(c.r) + "," + std::to_string(c.g) + "," + std::to_string(c.b) + ")";
+        }
+        return std::string("default");
+    };
+    return "'" + std::string(1, cell.ch) + "' fg=" + color(cell.fg) + " bg=" + color(cell.bg);
+}
+
+// Screen must show `expected` at the top-left and nothing anywhere else
+bool compareScreen(const CellGrid& screen, const CellGrid& expected, std::string& failure) {
+    for (int y = 0; y < screen.height(); ++y) {
+        for (int x = 0; x < screen.width(); ++x) {
+            bool in_frame = x < expected.width() && y < expected.height();
+            Cell want = in_frame ? expected.at(x, y) : Cell();
+            const Cell& got = screen.at(x, y);
+            if (got != want) {
+                failure = "cell (" + std::to_string(x) + "," + std::to_string(y) + ") expected " +
+                          describeCell(want) + ", got " + describeCell(got);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+std::string streamMessage(uint8_t type, const std::string& payload) {
+    std::string out(1, static_cast<char>(type));
+    appendVarint(out, payload.size());
+    return out + payload;
+}
+
+std::string keyframePayload(uint64_t width, uint64_t height, const std::string& cells) {
+    std::string payload;
+    appendVarint(payload, width);
+    appendVarint(payload, height);
+    return payload + cells;
+}
+
+// Streams a corrupt or hostile sender could produce; each must end in FAILED.
+// Returns how many were rejected, with the first that was not in `failure`.
+size_t checkMalformedStreams(std::string& failure) {
+    const std::string magic(cellstream::MAGIC, sizeof(cellstream::MAGIC));
+    const std::string square = streamMessage(cellstream::KEYFRAME, keyframePayload(2, 2, "abcd"));
+    std::string outside;
+    appendVarint(outside, 3);
+    appendVarint(outside, 5);
+    outside += "xxxxx";
+    // Only a header: the decoder must not wait for a terabyte
+    std::string huge = magic + static_cast<char>(cellstream::KEYFRAME);
+    appendVarint(huge, 1ull << 40);
+    const std::pair<const char*, std::string> cases[] = {
+        {"not a stream", "TVC0"},
+        // width * height wraps to 4 in 64 bits
+        {"keyframe size wraps",
+         magic + streamMessage(cellstream::KEYFRAME, keyframePayload(0xAAAAAAAAAAAAAAACull, 3, "abcd"))},
+        {"keyframe too wide", magic + streamMessage(cellstream::KEYFRAME, keyframePayload(70000, 1, "a"))},
+        {"keyframe too large", magic + streamMessage(cellstream::KEYFRAME, keyframePayload(4096, 4096, "a"))},
+        {"truncated keyframe", magic + streamMessage(cellstream::KEYFRAME, keyframePayload(4, 4, "ab"))},
+        {"repeat past the grid", magic + streamMessage(cellstream::KEYFRAME, keyframePayload(2, 2, "a\x02\x0a"))},
+        {"delta outside the grid", magic + square + streamMessage(cellstream::DELTA, outside)},
+        {"unknown message", magic + square + streamMessage('X', "")},
+        {"message too long", huge},
+        {"length never ends", magic + static_cast<char>(cellstream::KEYFRAME) + std::string(11, '\x80')},
+    };
+    size_t rejected = 0;
+    for (const auto& test : cases) {
+        CellStreamDecoder decoder;
+        CellGrid grid;
+        decoder.feed(reinterpret_cast<const uint8_t*>(test.second.data()), test.second.size());
+        CellStreamDecoder::Result result;
+        while ((result = decoder.next(grid)) == CellStreamDecoder::FRAME) {}
+        if (result == CellStreamDecoder::FAILED) {
+            rejected++;
+        } else if (failure.empty()) {
+            failure = std::string("malformed stream accepted: ") + test.first;
+        }
+    }
+
+    // A message cut short, even inside its length, is only waiting for the rest
+    const std::string whole = magic + streamMessage(cellstream::KEYFRAME, keyframePayload(200, 1, std::string(200, 'a')));
+    for (size_t size : {sizeof(cellstream::MAGIC) + 2, whole.size() - 1}) {
+        CellStreamDecoder decoder;
+        CellGrid grid;
+        decoder.feed(reinterpret_cast<const uint8_t*>(whole.data()), size);
+        if (decoder.next(grid) != CellStreamDecoder::NEED_MORE && failure.empty()) {
+            failure = "partial message rejected after " + std::to_string(size) + " bytes";
+        }
+    }
+    return rejected;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int frames = 400;
+    unsigned seed = 1;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) frames = std::atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--verbose" || arg == "-v") verbose = true;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--frames N] [--seed S] [--verbose]\n";
+            return 2;
+        }
+    }
+
+    std::vector<std::unique_ptr<Encoder>> encoders;
+    encoders.push_back(std::make_unique<FullFrameEncoder>("ascii-mono", RenderParams::MONO, false));
+    encoders.push_back(std::make_unique<FullFrameEncoder>("ascii-8bit", RenderParams::COLOR_8BIT, false));
+    encoders.push_back(std::make_unique<FullFrameEncoder>("ascii-24bit", RenderParams::COLOR_24BIT, false));
+    encoders.push_back(std::make_unique<FullFrameEncoder>("block-8bit", RenderParams::COLOR_8BIT, true));
+    encoders.push_back(std::make_unique<FullFrameEncoder>("block-24bit", RenderParams::COLOR_24BIT, true));
+    encoders.push_back(std::make_unique<InterlacedEncoder>("interlace-mono", RenderParams::MONO, false));
+    encoders.push_back(std::make_unique<InterlacedEncoder>("interlace-24bit", RenderParams::COLOR_24BIT, false));
+    encoders.push_back(std::make_unique<InterlacedEncoder>("interlace-blk-8", RenderParams::COLOR_8BIT, true));
+    encoders.push_back(std::make_unique<DeltaCheckEncoder>("delta-24bit", RenderParams::COLOR_24BIT, false, 0));
+    encoders.push_back(std::make_unique<DeltaCheckEncoder>("delta-1k-8bit", RenderParams::COLOR_8BIT, true, 1024));
+    encoders.push_back(std::make_unique<DeltaCheckEncoder>("delta-1k-24bit", RenderParams::COLOR_24BIT, false, 1024));
+    encoders.push_back(std::make_unique<StreamCheckEncoder>("stream-mono", RenderParams::MONO, false));
+    encoders.push_back(std::make_unique<StreamCheckEncoder>("stream-8bit", RenderParams::COLOR_8BIT, true));
+    encoders.push_back(std::make_unique<StreamCheckEncoder>("stream-24bit", RenderParams::COLOR_24BIT, false));
+    encoders.push_back(std::make_unique<StreamCheckEncoder>("stream-blk-24", RenderParams::COLOR_24BIT, true));
+    std::vector<EncoderResult> results(encoders.size());
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> src_w(8, 320), src_h(8, 240), grid_w(4, 100), grid_h(3, 40), seq_len(1, 12);
+
+    int done = 0;
+    while (done < frames) {
+        // One sequence: fixed source size and grid, evolving content
+        int width = src_w(rng), height = src_h(rng);
+        RenderParams params;
+        params.width = grid_w(rng);
+        params.height = grid_h(rng);
+        cv::Size grid = AsciiRenderer::gridSize(width, height, params.width, params.height);
+        if (grid.width <= 0 || grid.height <= 0) continue;
+
+        // The player leaves 2 columns and 3 rows of margin for the status line
+        std::vector<VtScreen> screens(encoders.size(), VtScreen(params.width + 2, params.height + 3));
+        for (size_t e = 0; e < encoders.size(); ++e) encoders[e]->restart(grid.width, grid.height);
+
+        unsigned scene_seed = static_cast<unsigned>(rng());
+        int length = std::min(seq_len(rng), frames - done);
+        for (size_t e = 0; e < encoders.size(); ++e) {
+            // Every encoder sees the same frames
+            std::mt19937 scene_rng(scene_seed);
+            SceneGenerator scene(scene_rng, width, height);
+            for (int t = 0; t < length; ++t) {
+                cv::Mat frame = scene.next(t);
+                std::string bytes;
+                CellGrid expected;
+                encoders[e]->encode(frame, params, bytes, expected);
+
+                VtScreen& screen = screens[e];
+                size_t unsupported_before = screen.unsupportedCount();
+                screen.feed(bytes);
+
+                EncoderResult& r = results[e];
+                r.frames++;
+                r.total_bytes += bytes.size();
+                r.max_bytes = std::max(r.max_bytes, bytes.size());
+                r.wire_bytes += encoders[e]->wireBytes();
+                if (screen.unsupportedCount() != unsupported_before) {
+                    r.unsupported++;
+                    if (r.first_failure.empty()) r.first_failure = "unsupported sequence: " + screen.lastUnsupported();
+                }
+                std::string failure;
+                if (!compareScreen(screen.grid(), expected, failure)) {
+                    r.mismatches++;
+                    if (r.first_failure.empty()) {
+                        r.first_failure = "frame " + std::to_string(r.frames - 1) + " (" + std::to_string(width) + "x" +
+                                          std::to_string(height) + " -> " + std::to_string(grid.width) + "x" +
+                                          std::to_string(grid.height) + "): " + failure;
+                    }
+                    if (verbose) std::cerr << encoders[e]->name() << ": " << failure << "\n";
+                }
+            }
+        }
+        done += length;
+    }
+
+    bool ok = true;
+    std::cout << std::left << std::setw(16) << "encoder" << std::right
+              << std::setw(8) << "frames" << std::setw(12) << "mismatches" << std::setw(13) << "unsupported"
+              << std::setw(14) << "bytes/frame" << std::setw(12) << "max bytes" << std::setw(12) << "wire/frame" << "\n";
+    for (size_t e = 0; e < encoders.size(); ++e) {
+        const EncoderResult& r = results[e];
+        std::cout << std::left << std::setw(16) << encoders[e]->name() << std::right
+                  << std::setw(8) << r.frames << std::setw(12) << r.mismatches << std::setw(13) << r.unsupported
+                  << std::setw(14) << (r.frames ? r.total_bytes / r.frames : 0) << std::setw(12) << r.max_bytes
+                  << std::setw(12) << (r.wire_bytes > 0 ? std::to_string(r.wire_bytes / r.frames) : "-") << "\n";
+        if (!r.first_failure.empty()) {
+            std::cout << "  first failure: " << r.first_failure << "\n";
+            ok = false;
+        }
+    }
+    std::string malformed_failure;
+    size_t rejected = checkMalformedStreams(malformed_failure);
+    std::cout << "malformed streams rejected: " << rejected << "\n";
+    if (!malformed_failure.empty()) {
+        std::cout << "  first failure: " << malformed_failure << "\n";
+        ok = false;
+    }
+    std::cout << (ok ? "PASS" : "FAIL") << " (seed " << seed << ")\n";
+    return ok ? 0 : 1;
+}
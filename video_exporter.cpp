@@ -0,0 +1,115 @@
+#include "video_exporter.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+bool VideoExporter::open(const std::string& path, double fps) {
+    close();
+    output_path = path;
+    output_fps = fps > 0.0 ? fps : 30.0;
+    frame_size = cv::Size();
+    frames_written = 0;
+    stopping = false;
+    failed = false;
+    active = true;
+    return true;
+}
+
+bool VideoExporter::close() {
+    if (!active) return !failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    if (thread.joinable()) thread.join();
+    writer.release();
+    queue.clear();
+    active = false;
+    // The writer reports little; an encoder that never produced output shows as an empty file
+    struct stat info;
+    if (!failed && frames_written > 0 && (::stat(output_path.c_str(), &info) != 0 || info.st_size == 0)) {
+        std::cerr << "Error: nothing was written to " << output_path << std::endl;
+        failed = true;
+    }
+    return !failed;
+}
+
+bool VideoExporter::write(const CellGrid& cells) {
+    if (!active || cells.width() == 0 || cells.height() == 0) return false;
+
+    cv::Mat image;
+    glyphs.rasterize(cells, image);
+
+    if (frame_size.width == 0) {
+        // Most codecs want even dimensions
+        frame_size = cv::Size(image.cols & ~1, image.rows & ~1);
+        std::string ext = output_path.substr(std::min(output_path.rfind('.'), output_path.size()));
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        int fourcc = (ext == ".avi") ? cv::VideoWriter::fourcc('M', 'J', 'P', 'G')
+                                     : cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+        if (!writer.open(output_path, fourcc, output_fps, frame_size, true) || !writer.isOpened()) {
+            std::cerr << "Error: cannot create video file " << output_path << std::endl;
+            failed = true;
+            active = false;
+            return false;
+        }
+        thread = std::thread(&VideoExporter::writerLoop, this);
+    }
+    if (image.cols != frame_size.width || image.rows != frame_size.height) {
+        cv::Mat canvas(frame_size.height, frame_size.width, CV_8UC3, cv::Scalar(0, 0, 0));
+        placeCentered(image, canvas);
+        image = canvas;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    queue_cv.wait(lock, [this]() { return queue.size() < MAX_QUEUED || failed; });
+    if (failed) return false;
+    queue.push_back(std::move(image));
+    frames_written++;
+    queue_cv.notify_all();
+    return true;
+}
+
+size_t VideoExporter::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t bytes = glyphs.memoryUsage();
+    for (const auto& image : queue) bytes += image.total() * image.elemSize();
+    return bytes;
+}
+
+void VideoExporter::writerLoop() {
+    while (true) {
+        cv::Mat image;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue_cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            image = std::move(queue.front());
+            queue.pop_front();
+        }
+        queue_cv.notify_all();
+        writer.write(image);
+        if (!writer.isOpened()) {
+            std::cerr << "Error: writing " << output_path << " failed" << std::endl;
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+            queue.clear();
+            queue_cv.notify_all();
+            return;
+        }
+    }
+}
+
+void VideoExporter::placeCentered(const cv::Mat& image, cv::Mat& canvas) {
+    int w = std::min(image.cols, canvas.cols);
+    int h = std::min(image.rows, canvas.rows);
+    int src_x = (image.cols - w) / 2, src_y = (image.rows - h) / 2;
+    int dst_x = (canvas.cols - w) / 2, dst_y = (canvas.rows - h) / 2;
+    for (int y = 0; y < h; ++y) {
+        std::memcpy(canvas.ptr<uint8_t>(dst_y + y) + dst_x * 3, image.ptr<uint8_t>(src_y + y) + src_x * 3,
+                    static_cast<size_t>(w) * 3);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "cell_grid.hpp"
+#include "glyph_atlas.hpp"
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes what the player would show to a video file instead of a terminal.
+// Each cell grid is drawn through a glyph atlas on the caller's thread and
+// handed to a writer thread, so encoding the previous frame overlaps with
+// decoding and drawing the next. The queue between them is short; a slow
+// encoder makes write() wait rather than piling up frames in memory.
+class VideoExporter {
+public:
+    VideoExporter() = default;
+    ~VideoExporter() { close(); }
+    VideoExporter(const VideoExporter&) = delete;
+    VideoExporter& operator=(const VideoExporter&) = delete;
+
+    // The file is created with the first frame, once the image size is known.
+    // ".avi" gets Motion JPEG, anything else MPEG-4 Part 2.
+    bool open(const std::string& path, double fps);
+    // Waits for queued frames to be encoded and closes the file.
+    // False if the file could not be created, the writer closed while
+    // encoding, or the finished file is empty.
+    bool close();
+
+    // Queues one frame. The video keeps the size of the first frame; later
+    // grids of another size are centered on black.
+    bool write(const CellGrid& cells);
+
+    size_t frames() const { return frames_written; }
+    cv::Size frameSize() const { return frame_size; }
+    // Approximate heap bytes held by the atlas and queued images
+    size_t memoryUsage() const;
+
+private:
+    static const size_t MAX_QUEUED = 4;
+
+    void writerLoop();
+    static void placeCentered(const cv::Mat& image, cv::Mat& canvas);
+
+    GlyphAtlas glyphs;
+    std::string output_path;
+    double output_fps = 0.0;
+    cv::Size frame_size;
+    size_t frames_written = 0;
+
+    cv::VideoWriter writer;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable queue_cv;
+    std::deque<cv::Mat> queue;
+    bool stopping = false;
+    bool failed = false;
+    bool active = false;
+};
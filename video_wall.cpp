@@ -0,0 +1,201 @@
+#include "video_wall.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+const char BEGIN_UPDATE[] = "\033[?2026h";
+const char END_UPDATE[] = "\033[?2026l";
+
+} // namespace
+
+bool VideoWall::open(const std::vector<std::string>& paths, int columns) {
+    close();
+    if (paths.empty()) return false;
+
+    tile_width = tile_height = 0;
+    for (const auto& path : paths) {
+        std::unique_ptr<Output> output(new Output());
+        output->path = path;
+        output->fd = ::open(path.c_str(), O_WRONLY | O_NOCTTY);
+        if (output->fd < 0) {
+            std::cerr << "Error: cannot open wall output " << path << std::endl;
+            outputs.clear();
+            return false;
+        }
+        // Opening may wait for a FIFO reader, but writes must never block
+        fcntl(output->fd, F_SETFL, fcntl(output->fd, F_GETFL) | O_NONBLOCK);
+        // Files and pipes have no size; assume a classic terminal
+        struct winsize w;
+        int width = 80, height = 24;
+        if (ioctl(output->fd, TIOCGWINSZ, &w) == 0 && w.ws_col > 0 && w.ws_row > 0) {
+            width = w.ws_col;
+            height = w.ws_row;
+        }
+        tile_width = tile_width ? std::min(tile_width, width) : width;
+        tile_height = tile_height ? std::min(tile_height, height) : height;
+        if (!writeAll(*output, "\033[?25l", Clock::now() + std::chrono::milliseconds(STALL_GRACE_MS))) {
+            std::cerr << "Warning: wall output " << path << " is not accepting writes" << std::endl;
+            output->failed = true;
+        }
+        outputs.push_back(std::move(output));
+    }
+
+    int count = static_cast<int>(outputs.size());
+    wall_columns = (columns > 0) ? std::min(columns, count) : count;
+    wall_rows = (count + wall_columns - 1) / wall_columns;
+
+    posted = 0;
+    stopping = false;
+    totals = Stats();
+    skew_total_ms = 0.0;
+    for (auto& output : outputs) {
+        output->thread = std::thread(&VideoWall::writerLoop, this, std::ref(*output));
+    }
+    return true;
+}
+
+void VideoWall::close() {
+    if (outputs.empty()) return;
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& output : outputs) {
+        if (output->thread.joinable()) output->thread.join();
+        if (!output->failed) {
+            writeAll(*output, "\033[0m\033[?25h\n", Clock::now() + std::chrono::milliseconds(STALL_GRACE_MS));
+        }
+        ::close(output->fd);
+    }
+    outputs.clear();
+}
+
+void VideoWall::present(const CellGrid& frame, Clock::time_point when) {
+    finish();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Writers are idle now, so their tiles can be replaced without copies in flight
+    int tile_w = (frame.width() + wall_columns - 1) / wall_columns;
+    int tile_h = (frame.height() + wall_rows - 1) / wall_rows;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        int x0 = static_cast<int>(i % wall_columns) * tile_w;
+        int y0 = static_cast<int>(i / wall_columns) * tile_h;
+        int w = std::max(std::min(tile_w, frame.width() - x0), 0);
+        int h = std::max(std::min(tile_h, frame.height() - y0), 0);
+        CellGrid& tile = outputs[i]->tile;
+        if (tile.width() != w || tile.height() != h) tile.resize(w, h);
+        for (int y = 0; y < h; ++y) {
+            std::copy(frame.row(y0 + y) + x0, frame.row(y0 + y) + x0 + w, tile.row(y));
+        }
+    }
+    deadline = when;
+    posted++;
+    work_cv.notify_all();
+}
+
+void VideoWall::finish() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (posted == 0 || totals.frames == posted) return;
+    done_cv.wait(lock, [this]() {
+        return std::all_of(outputs.begin(), outputs.end(),
+                           [this](const std::unique_ptr<Output>& o) { return o->done == posted; });
+    });
+    collectFrame();
+}
+
+void VideoWall::collectFrame() {
+    // Skew over the outputs that still work; a dead terminal is not late
+    Clock::time_point first = Clock::time_point::max(), last = Clock::time_point::min();
+    bool late = false;
+    size_t failed = 0;
+    for (const auto& output : outputs) {
+        if (output->failed) {
+            failed++;
+            continue;
+        }
+        first = std::min(first, output->presented);
+        last = std::max(last, output->presented);
+        late = late || output->staged_late;
+    }
+    totals.frames = posted;
+    totals.failed_outputs = failed;
+    if (late) totals.late_frames++;
+    if (failed < outputs.size()) {
+        double skew = std::chrono::duration<double, std::milli>(last - first).count();
+        skew_total_ms += skew;
+        totals.skew_max_ms = std::max(totals.skew_max_ms, skew);
+    }
+}
+
+VideoWall::Stats VideoWall::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = totals;
+    result.skew_avg_ms = totals.frames > 0 ? skew_total_ms / totals.frames : 0.0;
+    for (const auto& output : outputs) result.bytes += output->bytes;
+    return result;
+}
+
+void VideoWall::writerLoop(Output& output) {
+    uint64_t seen = 0;
+    while (true) {
+        Clock::time_point when;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_cv.wait(lock, [&]() { return stopping || posted > seen; });
+            if (posted == seen) return;
+            seen = posted;
+            when = deadline;
+        }
+
+        // Stage the tile early, then end the update at the deadline
+        std::string bytes = BEGIN_UPDATE;
+        output.encoder.encode(output.tile, bytes);
+        // A frame posted after its deadline (present() waited) still gets the grace
+        Clock::time_point limit = std::max(when, Clock::now()) + std::chrono::milliseconds(STALL_GRACE_MS);
+        bool ok = !output.failed && writeAll(output, bytes, limit);
+        bool late = Clock::now() > when;
+        std::this_thread::sleep_until(when);
+        ok = ok && writeAll(output, END_UPDATE, limit);
+        Clock::time_point presented = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ok && !output.failed) {
+                std::cerr << "Warning: wall output " << output.path << " stopped accepting writes" << std::endl;
+                output.failed = true;
+            }
+            output.done = seen;
+            output.presented = presented;
+            output.staged_late = late;
+            if (ok) output.bytes += bytes.size() + sizeof(END_UPDATE) - 1;
+        }
+        done_cv.notify_all();
+    }
+}
+
+bool VideoWall::writeAll(Output& output, const std::string& data, Clock::time_point limit) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = ::write(output.fd, data.data() + offset, data.size() - offset);
+        if (n >= 0) {
+            offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+        // The terminal is full; wait for room, but not past the limit
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(limit - Clock::now()).count();
+        if (left <= 0) return false;
+        pollfd ready = {output.fd, POLLOUT, 0};
+        if (::poll(&ready, 1, static_cast<int>(left)) < 0 && errno != EINTR) return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "cell_grid.hpp"
+#include "delta_encoder.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One picture spread over several terminals (ttys or ptys), left to right
+// and then top to bottom. The caller renders the whole wall once; each
+// output gets its tile and a writer thread that encodes only the changed
+// cells, sends them inside a synchronized update (mode 2026) ahead of time
+// and ends the update at a shared deadline, so all tiles change together.
+// Terminals without mode 2026 show the tile as it arrives instead.
+// Writes never block: an output that has not taken its frame shortly after
+// the deadline (its reader stopped, or sent XOFF) is dropped from the wall.
+class VideoWall {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        size_t frames = 0;
+        size_t late_frames = 0;   // some tile was not staged by the deadline
+        double skew_avg_ms = 0.0; // spread between the first and last output to present
+        double skew_max_ms = 0.0;
+        size_t bytes = 0;
+        size_t failed_outputs = 0;
+    };
+
+    VideoWall() = default;
+    ~VideoWall() { close(); }
+    VideoWall(const VideoWall&) = delete;
+    VideoWall& operator=(const VideoWall&) = delete;
+
+    // Opens every path for writing; `columns` tiles per row, 0 for one row
+    bool open(const std::vector<std::string>& paths, int columns);
+    void close();
+
+    int columns() const { return wall_columns; }
+    int rows() const { return wall_rows; }
+    // Cells every output can show: the smallest of their terminal sizes
+    int tileWidth() const { return tile_width; }
+    int tileHeight() const { return tile_height; }
+
+    // Waits until the previous frame is presented everywhere, then hands
+    // each output its part of `frame`, to be shown at `deadline`
+    void present(const CellGrid& frame, Clock::time_point deadline);
+    // Waits for the last frame to be presented
+    void finish();
+
+    Stats stats() const;
+
+private:
+    struct Output {
+        std::string path;
+        int fd = -1;
+        bool failed = false;
+        DeltaEncoder encoder;
+        CellGrid tile;
+        std::thread thread;
+        uint64_t done = 0;
+        Clock::time_point presented;
+        bool staged_late = false;
+        size_t bytes = 0;
+    };
+
+    // How long past a frame's deadline a stalled output is waited for
+    static constexpr int STALL_GRACE_MS = 500;
+
+    void writerLoop(Output& output);
+    bool writeAll(Output& output, const std::string& data, Clock::time_point limit);
+    void collectFrame();
+
+    std::vector<std::unique_ptr<Output>> outputs;
+    int wall_columns = 0;
+    int wall_rows = 0;
+    int tile_width = 0;
+    int tile_height = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    uint64_t posted = 0;
+    Clock::time_point deadline;
+    bool stopping = false;
+    Stats totals;
+    double skew_total_ms = 0.0;
+};
@@ -0,0 +1,46 @@
+#include "viewport.hpp"
+#include <algorithm>
+#include <cmath>
+
+void Viewport::zoomIn() {
+    zoom = std::min(zoom * ZOOM_STEP, MAX_ZOOM);
+    clampCenter();
+}
+
+void Viewport::zoomOut() {
+    zoom = std::max(zoom / ZOOM_STEP, 1.0);
+    clampCenter();
+}
+
+void Viewport::pan(double dx, double dy) {
+    center_x += dx * PAN_STEP / zoom;
+    center_y += dy * PAN_STEP / zoom;
+    clampCenter();
+}
+
+void Viewport::reset() {
+    zoom = 1.0;
+    center_x = 0.5;
+    center_y = 0.5;
+}
+
+void Viewport::clampCenter() {
+    double half = 0.5 / zoom;
+    center_x = std::min(std::max(center_x, half), 1.0 - half);
+    center_y = std::min(std::max(center_y, half), 1.0 - half);
+}
+
+cv::Rect Viewport::apply(const cv::Rect& bounds) const {
+    if (zoom <= 1.0 || bounds.empty()) return bounds;
+    
+    int width = std::max(static_cast<int>(std::lround(bounds.width / zoom)), 2);
+    int height = std::max(static_cast<int>(std::lround(bounds.height / zoom)), 2);
+    width = std::min(width, bounds.width);
+    height = std::min(height, bounds.height);
+    
+    int x = bounds.x + static_cast<int>(std::lround(center_x * bounds.width - width / 2.0));
+    int y = bounds.y + static_cast<int>(std::lround(center_y * bounds.height - height / 2.0));
+    x = std::min(std::max(x, bounds.x), bounds.x + bounds.width - width);
+    y = std::min(std::max(y, bounds.y), bounds.y + bounds.height - height);
+    return cv::Rect(x, y, width, height);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Keyboard-driven zoom and pan. The view is kept in normalized coordinates
+// so it maps onto whatever region it is applied to (full frame or autocrop).
+class Viewport {
+public:
+    static constexpr double MAX_ZOOM = 8.0;
+    static constexpr double ZOOM_STEP = 1.25;
+    static constexpr double PAN_STEP = 0.25; // fraction of the visible width/height
+    
+    void zoomIn();
+    void zoomOut();
+    void pan(double dx, double dy);
+    void reset();
+    
+    bool isZoomed() const { return zoom > 1.0; }
+    double zoomLevel() const { return zoom; }
+    
+    // Source-space ROI within `bounds`; never larger than `bounds`
+    cv::Rect apply(const cv::Rect& bounds) const;
+    
+private:
+    void clampCenter();
+    
+    double zoom = 1.0;
+    double center_x = 0.5;
+    double center_y = 0.5;
+};
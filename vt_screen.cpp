@@ -0,0 +1,394 @@
+#include "vt_screen.hpp"
+#include <algorithm>
+
+VtScreen::VtScreen(int width, int height) : width(std::max(width, 1)), height(std::max(height, 1)) {
+    reset();
+}
+
+void VtScreen::reset() {
+    screen.resize(width, height);
+    cx = cy = 0;
+    saved_x = saved_y = 0;
+    wrap_pending = false;
+    fg = CellColor();
+    bg = CellColor();
+    last_printed = ' ';
+    scroll_top = 0;
+    scroll_bottom = height - 1;
+    state = GROUND;
+    params.clear();
+    param_open = false;
+    private_marker = 0;
+    intermediates.clear();
+}
+
+void VtScreen::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        char ch = data[i];
+        unsigned char byte = static_cast<unsigned char>(ch);
+
+        switch (state) {
+            case GROUND:
+                if (byte == 0x1b) {
+                    state = ESCAPE;
+                } else if (byte < 0x20 || byte == 0x7f) {
+                    control(ch);
+                } else if (byte >= 0x80) {
+                    flagUnsupported("non-ASCII byte");
+                    print('?');
+                } else {
+                    print(ch);
+                }
+                break;
+
+            case ESCAPE:
+                escape(ch);
+                break;
+
+            case CSI_ENTRY:
+            case CSI_PARAM:
+                if (byte == 0x1b) {
+                    flagUnsupported("interrupted CSI");
+                    state = ESCAPE;
+                } else if (byte < 0x20) {
+                    control(ch); // C0 controls execute inside CSI
+                } else if (state == CSI_ENTRY && (ch == '?' || ch == '>' || ch == '=' || ch == '<')) {
+                    private_marker = ch;
+                    state = CSI_PARAM;
+                } else if (ch >= '0' && ch <= '9') {
+                    if (!param_open) {
+                        params.push_back(0);
+                        param_open = true;
+                    }
+                    params.back() = std::min(params.back() * 10 + (ch - '0'), 65535);
+                    state = CSI_PARAM;
+                } else if (ch == ';' || ch == ':') {
+                    if (!param_open) params.push_back(-1);
+                    param_open = false;
+                    state = CSI_PARAM;
+                } else if (byte >= 0x20 && byte <= 0x2f) {
+                    intermediates += ch;
+                    state = CSI_PARAM;
+                } else if (byte >= 0x40 && byte <= 0x7e) {
+                    executeCsi(ch);
+                    state = GROUND;
+                } else {
+                    flagUnsupported("bad CSI byte");
+                    state = GROUND;
+                }
+                break;
+
+            case STRING:
+                if (byte == 0x1b) state = STRING_ESCAPE;
+                else if (byte == 0x07) state = GROUND; // BEL ends OSC
+                break;
+
+            case STRING_ESCAPE:
+                state = (ch == '\\') ? GROUND : STRING;
+                break;
+        }
+    }
+}
+
+void VtScreen::control(char ch) {
+    switch (ch) {
+        case '\r':
+            cx = 0;
+            wrap_pending = false;
+            break;
+        case '\n': case '\v': case '\f':
+            if (onlcr) cx = 0;
+            wrap_pending = false;
+            lineFeed();
+            break;
+        case '\b':
+            if (cx > 0) cx--;
+            wrap_pending = false;
+            break;
+        case '\t':
+            cx = std::min((cx / 8 + 1) * 8, width - 1);
+            break;
+        case '\a':
+            break;
+        default:
+            flagUnsupported("C0 control");
+            break;
+    }
+}
+
+void VtScreen::escape(char ch) {
+    state = GROUND;
+    switch (ch) {
+        case '[':
+            params.clear();
+            param_open = false;
+            private_marker = 0;
+            intermediates.clear();
+            state = CSI_ENTRY;
+            break;
+        case 'P': case '_': case ']': case '^': case 'X':
+            // DCS (sixel), APC (kitty graphics), OSC, PM, SOS: no cell content
+            state = STRING;
+            break;
+        case '\\':
+            break; // stray ST
+        case 'D':
+            lineFeed();
+            break;
+        case 'E':
+            cx = 0;
+            lineFeed();
+            break;
+        case 'M':
+            reverseIndex();
+            break;
+        case '7':
+            saved_x = cx;
+            saved_y = cy;
+            break;
+        case '8':
+            moveTo(saved_x, saved_y);
+            break;
+        case 'c':
+            reset();
+            break;
+        default:
+            flagUnsupported(std::string("ESC ") + ch);
+            break;
+    }
+}
+
+int VtScreen::param(size_t i, int def) const {
+    if (i >= params.size() || params[i] < 0) return def;
+    return params[i];
+}
+
+void VtScreen::moveTo(int x, int y) {
+    cx = std::min(std::max(x, 0), width - 1);
+    cy = std::min(std::max(y, 0), height - 1);
+    wrap_pending = false;
+}
+
+void VtScreen::executeCsi(char final_byte) {
+    if (!intermediates.empty()) {
+        flagUnsupported(std::string("CSI with intermediates ") + final_byte);
+        return;
+    }
+    if (private_marker == '?') {
+        if (final_byte == 'h' || final_byte == 'l') setPrivateMode(final_byte == 'h');
+        else flagUnsupported(std::string("CSI ? ") + final_byte);
+        return;
+    }
+    if (private_marker) {
+        flagUnsupported(std::string("CSI ") + private_marker + " " + final_byte);
+        return;
+    }
+
+    // Counts default to 1, and an explicit 0 also means 1
+    int n = std::max(param(0, 1), 1);
+    switch (final_byte) {
+        case 'H': case 'f':
+            moveTo(std::max(param(1, 1), 1) - 1, std::max(param(0, 1), 1) - 1);
+            break;
+        case 'A': moveTo(cx, cy - n); break;
+        case 'B': moveTo(cx, cy + n); break;
+        case 'C': moveTo(cx + n, cy); break;
+        case 'D': moveTo(cx - n, cy); break;
+        case 'E': moveTo(0, cy + n); break;
+        case 'F': moveTo(0, cy - n); break;
+        case 'G': moveTo(n - 1, cy); break;
+        case 'd': moveTo(cx, n - 1); break;
+        case 'J':
+            switch (param(0, 0)) {
+                case 0:
+                    eraseCells(cy, cx, width - 1);
+                    eraseLines(cy + 1, height - 1);
+                    break;
+                case 1:
+                    eraseLines(0, cy - 1);
+                    eraseCells(cy, 0, cx);
+                    break;
+                case 2: case 3:
+                    eraseLines(0, height - 1);
+                    break;
+                default:
+                    flagUnsupported("ED mode");
+            }
+            break;
+        case 'K':
+            switch (param(0, 0)) {
+                case 0: eraseCells(cy, cx, width - 1); break;
+                case 1: eraseCells(cy, 0, cx); break;
+                case 2: eraseCells(cy, 0, width - 1); break;
+                default: flagUnsupported("EL mode");
+            }
+            break;
+        case 'X':
+            eraseCells(cy, cx, std::min(cx + n - 1, width - 1));
+            wrap_pending = false;
+            break;
+        case 'b':
+            for (int i = 0; i < n; ++i) print(last_printed);
+            break;
+        case 'r': {
+            int top = std::max(param(0, 1), 1) - 1;
+            int bottom = std::min(param(1, height), height) - 1;
+            if (top < bottom) {
+                scroll_top = top;
+                scroll_bottom = bottom;
+            }
+            moveTo(0, 0);
+            break;
+        }
+        case 'S': scrollUp(n); break;
+        case 'T': scrollDown(n); break;
+        case 's':
+            saved_x = cx;
+            saved_y = cy;
+            break;
+        case 'u':
+            moveTo(saved_x, saved_y);
+            break;
+        case 'm':
+            selectGraphicRendition();
+            break;
+        default:
+            flagUnsupported(std::string("CSI ") + final_byte);
+            break;
+    }
+}
+
+void VtScreen::selectGraphicRendition() {
+    if (params.empty()) {
+        fg = CellColor();
+        bg = CellColor();
+        return;
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        int p = params[i] < 0 ? 0 : params[i];
+        if (p == 0) {
+            fg = CellColor();
+            bg = CellColor();
+        } else if (p == 39) {
+            fg = CellColor();
+        } else if (p == 49) {
+            bg = CellColor();
+        } else if (p >= 30 && p <= 37) {
+            fg = CellColor::indexed(p - 30);
+        } else if (p >= 40 && p <= 47) {
+            bg = CellColor::indexed(p - 40);
+        } else if (p >= 90 && p <= 97) {
+            fg = CellColor::indexed(p - 90 + 8);
+        } else if (p >= 100 && p <= 107) {
+            bg = CellColor::indexed(p - 100 + 8);
+        } else if (p == 38 || p == 48) {
+            CellColor& target = (p == 38) ? fg : bg;
+            int kind = param(i + 1, -1);
+            if (kind == 5 && i + 2 < params.size()) {
+                target = CellColor::indexed(std::min(param(i + 2, 0), 255));
+                i += 2;
+            } else if (kind == 2 && i + 4 < params.size()) {
+                target = CellColor::rgb(std::min(param(i + 2, 0), 255), std::min(param(i + 3, 0), 255),
+                                        std::min(param(i + 4, 0), 255));
+                i += 4;
+            } else {
+                flagUnsupported("malformed extended color");
+                return;
+            }
+        } else {
+            flagUnsupported("SGR " + std::to_string(p));
+        }
+    }
+}
+
+void VtScreen::setPrivateMode(bool enable) {
+    for (size_t i = 0; i < params.size(); ++i) {
+        switch (param(i, 0)) {
+            case 25:    // cursor visibility
+            case 2026:  // synchronized output
+                break;
+            case 1049:
+                // Alternate screen: the model has one buffer, entering clears it
+                if (enable) {
+                    saved_x = cx;
+                    saved_y = cy;
+                    eraseLines(0, height - 1);
+                } else {
+                    moveTo(saved_x, saved_y);
+                }
+                break;
+            default:
+                flagUnsupported("private mode " + std::to_string(param(i, 0)));
+        }
+    }
+}
+
+void VtScreen::print(char ch) {
+    if (wrap_pending) {
+        cx = 0;
+        lineFeed();
+        wrap_pending = false;
+    }
+    Cell& cell = screen.at(cx, cy);
+    cell.ch = ch;
+    cell.fg = fg;
+    cell.bg = bg;
+    last_printed = ch;
+    if (cx == width - 1) {
+        wrap_pending = true;
+    } else {
+        cx++;
+    }
+}
+
+void VtScreen::lineFeed() {
+    if (cy == scroll_bottom) {
+        scrollUp(1);
+    } else if (cy < height - 1) {
+        cy++;
+    }
+}
+
+void VtScreen::reverseIndex() {
+    if (cy == scroll_top) {
+        scrollDown(1);
+    } else if (cy > 0) {
+        cy--;
+    }
+}
+
+void VtScreen::scrollUp(int lines) {
+    lines = std::min(lines, scroll_bottom - scroll_top + 1);
+    for (int y = scroll_top; y <= scroll_bottom - lines; ++y) {
+        std::copy(screen.row(y + lines), screen.row(y + lines) + width, screen.row(y));
+    }
+    eraseLines(scroll_bottom - lines + 1, scroll_bottom);
+}
+
+void VtScreen::scrollDown(int lines) {
+    lines = std::min(lines, scroll_bottom - scroll_top + 1);
+    for (int y = scroll_bottom; y >= scroll_top + lines; --y) {
+        std::copy(screen.row(y - lines), screen.row(y - lines) + width, screen.row(y));
+    }
+    eraseLines(scroll_top, scroll_top + lines - 1);
+}
+
+void VtScreen::eraseCells(int y, int x0, int x1) {
+    // Background color erase, as xterm does
+    Cell blank;
+    blank.bg = bg;
+    for (int x = std::max(x0, 0); x <= std::min(x1, width - 1); ++x) {
+        screen.at(x, y) = blank;
+    }
+}
+
+void VtScreen::eraseLines(int y0, int y1) {
+    for (int y = std::max(y0, 0); y <= std::min(y1, height - 1); ++y) {
+        eraseCells(y, 0, width - 1);
+    }
+}
+
+void VtScreen::flagUnsupported(const std::string& what) {
+    unsupported++;
+    last_unsupported = what;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "cell_grid.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Reference model of an xterm-compatible screen, limited to the sequences
+// our encoders emit: printable ASCII, CR/LF/BS/TAB, cursor movement (CUP,
+// CUU/CUD/CUF/CUB, CHA, VPA), erase (ED, EL, ECH), REP, scroll regions
+// (DECSTBM, SU/SD, IND/RI) and color SGR. DCS/APC/OSC strings (sixel,
+// kitty graphics) are skipped. Anything else is counted as unsupported,
+// so a checker can assert that an encoder stays within the modeled subset.
+class VtScreen {
+public:
+    VtScreen(int width, int height);
+
+    void feed(const char* data, size_t length);
+    void feed(const std::string& data) { feed(data.data(), data.size()); }
+    void reset();
+
+    const CellGrid& grid() const { return screen; }
+    int cursorX() const { return cx; }
+    int cursorY() const { return cy; }
+
+    size_t unsupportedCount() const { return unsupported; }
+    const std::string& lastUnsupported() const { return last_unsupported; }
+
+    // LF also returns the carriage, as the tty's ONLCR output mapping does
+    bool onlcr = true;
+
+private:
+    enum State { GROUND, ESCAPE, CSI_ENTRY, CSI_PARAM, STRING, STRING_ESCAPE };
+
+    void print(char ch);
+    void control(char ch);
+    void escape(char ch);
+    void executeCsi(char final_byte);
+    void selectGraphicRendition();
+    void setPrivateMode(bool enable);
+
+    void lineFeed();
+    void reverseIndex();
+    void scrollUp(int lines);
+    void scrollDown(int lines);
+    void eraseCells(int y, int x0, int x1);
+    void eraseLines(int y0, int y1);
+    void moveTo(int x, int y);
+    int param(size_t i, int def) const;
+    void flagUnsupported(const std::string& what);
+
+    int width;
+    int height;
+    CellGrid screen;
+
+    int cx = 0, cy = 0;
+    int saved_x = 0, saved_y = 0;
+    bool wrap_pending = false;
+    CellColor fg, bg;
+    char last_printed = ' ';
+    int scroll_top = 0;
+    int scroll_bottom = 0;
+
+    State state = GROUND;
+    std::vector<int> params;    // -1 marks an omitted parameter
+    bool param_open = false;
+    char private_marker = 0;
+    std::string intermediates;
+
+    size_t unsupported = 0;
+    std::string last_unsupported;
+};